@@ -0,0 +1,124 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+// Compares the two ways a TVHeadend or Kodi reply was turned into a QJsonDocument: the old path converted the
+// received bytes to a QString and back with toUtf8(), the current one parses the bytes from readAll() directly.
+// A captured reply can be passed as the first argument, otherwise a generated EPG grid reply is used.
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <QTextStream>
+
+#define REPLYCOPY_EVENTS 1000
+#define REPLYCOPY_ITERATIONS 200
+
+// an /api/epg/events/grid reply with the fields TVHeadend sends for every event
+static QByteArray epgGridReply(int events) {
+    QByteArray reply = "{\"entries\":[";
+    for (int i = 0; i < events; i++) {
+        if (i > 0) {
+            reply += ',';
+        }
+        uint start = 1600000000 + static_cast<uint>(i) * 1800;
+        reply += QString("{\"eventId\":%1,\"episodeId\":%2,\"channelName\":\"Das Erste HD\","
+                         "\"channelUuid\":\"0c8b9a3d5e2f41a7b6c4d3e2f1a0b9c8\",\"channelNumber\":\"%3\","
+                         "\"channelIcon\":\"imagecache/%3\",\"start\":%4,\"stop\":%5,"
+                         "\"title\":\"Tagesschau %1\",\"subtitle\":\"Nachrichten aus Deutschland und der Welt\","
+                         "\"description\":\"Die Themen des Tages, dazu das Wetter für München und Köln. "
+                         "Anschließend ein Bericht über die Lage in Übersee.\",\"genre\":[32],"
+                         "\"nextEventId\":%6}")
+                     .arg(i)
+                     .arg(100000 + i)
+                     .arg(i % 50 + 1)
+                     .arg(start)
+                     .arg(start + 1800)
+                     .arg(i + 1)
+                     .toUtf8();
+    }
+    reply += "],\"totalCount\":" + QByteArray::number(events) + "}";
+    return reply;
+}
+
+// stands in for QNetworkReply::readAll(), which hands out a new buffer for every reply
+static QByteArray readAll(const QByteArray& received) { return QByteArray(received.constData(), received.size()); }
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream      out(stdout);
+
+    QByteArray received;
+    if (argc > 1) {
+        QFile file(QString::fromLocal8Bit(argv[1]));
+        if (!file.open(QIODevice::ReadOnly)) {
+            out << "Could not read " << argv[1] << ": " << file.errorString() << "\n";
+            return 1;
+        }
+        received = file.readAll();
+    } else {
+        received = epgGridReply(REPLYCOPY_EVENTS);
+    }
+
+    // old path: readAll() -> QString (UTF-16) -> toUtf8() -> fromJson()
+    qint64        oldBytes = 0;
+    int           oldEntries = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < REPLYCOPY_ITERATIONS; i++) {
+        QByteArray    bytes = readAll(received);
+        QString       answer = bytes;
+        QByteArray    utf8 = answer.toUtf8();
+        QJsonDocument doc = QJsonDocument::fromJson(utf8);
+        oldBytes += bytes.size() + answer.size() * static_cast<qint64>(sizeof(QChar)) + utf8.size();
+        oldEntries += doc.object().value("entries").toArray().count();
+    }
+    qint64 oldTime = timer.nsecsElapsed();
+
+    // current path: readAll() -> fromJson()
+    qint64 newBytes = 0;
+    int    newEntries = 0;
+    timer.restart();
+    for (int i = 0; i < REPLYCOPY_ITERATIONS; i++) {
+        QByteArray    bytes = readAll(received);
+        QJsonDocument doc = QJsonDocument::fromJson(bytes);
+        newBytes += bytes.size();
+        newEntries += doc.object().value("entries").toArray().count();
+    }
+    qint64 newTime = timer.nsecsElapsed();
+
+    if (oldEntries != newEntries) {
+        out << "The paths parsed different documents\n";
+        return 1;
+    }
+    out << "reply size:        " << received.size() << " bytes, " << newEntries / REPLYCOPY_ITERATIONS
+        << " entries\n";
+    out << "QString + toUtf8:  " << oldBytes / REPLYCOPY_ITERATIONS << " bytes copied, "
+        << oldTime / REPLYCOPY_ITERATIONS / 1000 << " us per reply\n";
+    out << "fromJson(readAll): " << newBytes / REPLYCOPY_ITERATIONS << " bytes copied, "
+        << newTime / REPLYCOPY_ITERATIONS / 1000 << " us per reply\n";
+    return 0;
+}
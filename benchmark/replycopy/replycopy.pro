@@ -0,0 +1,10 @@
+# Standalone benchmark of the bytes copied per HTTP reply before it is parsed, not part of the plugin build:
+#   qmake && make && ./replycopy [captured-reply.json]
+TEMPLATE  = app
+CONFIG   += console
+CONFIG   -= app_bundle
+QT       += core
+QT       -= gui
+
+SOURCES  += main.cpp
+TARGET    = replycopy
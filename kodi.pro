@@ -1,6 +1,6 @@
 TEMPLATE  = lib
 CONFIG   += plugin
-QT       += core quick network
+QT       += core quick network concurrent
 
 
 
@@ -81,8 +81,28 @@ unix {
 QMAKE_SUBSTITUTES += kodi.json.in version.txt.in
 # output path must be included for the output file from QMAKE_SUBSTITUTES
 INCLUDEPATH += $$OUT_PWD
-HEADERS  += src/kodi.h
-SOURCES  += src/kodi.cpp
+HEADERS  += src/kodi.h \
+            src/channelcache.h \
+            src/epggridlayout.h \
+            src/epggridreader.h \
+            src/epgstore.h \
+            src/jsonrpcrequest.h \
+            src/jsonstreamframer.h \
+            src/logocache.h \
+            src/pollingscheduler.h \
+            src/requestqueue.h \
+            src/stringpool.h
+SOURCES  += src/kodi.cpp \
+            src/channelcache.cpp \
+            src/epggridlayout.cpp \
+            src/epggridreader.cpp \
+            src/epgstore.cpp \
+            src/jsonrpcrequest.cpp \
+            src/jsonstreamframer.cpp \
+            src/logocache.cpp \
+            src/pollingscheduler.cpp \
+            src/requestqueue.cpp \
+            src/stringpool.cpp
 TARGET    = kodi
 
 # Configure destination path. DESTDIR is set in qmake-destination-path.pri
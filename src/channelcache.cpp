@@ -0,0 +1,131 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#include "channelcache.h"
+
+#include <QCryptographicHash>
+#include <QJsonObject>
+
+void ChannelCache::translateStrings(StringPool* strings) {
+    for (KodiChannel& channel : m_channels) {
+        channel.label = strings->intern(m_strings->value(channel.label));
+        channel.image = strings->intern(m_strings->value(channel.image));
+        channel.tvheadendUuid = strings->intern(m_strings->value(channel.tvheadendUuid));
+    }
+    index();
+}
+
+void ChannelCache::clear() {
+    m_channels.clear();
+    m_byChannelId.clear();
+    m_byChannelNumber.clear();
+    m_byTVHeadendUuid.clear();
+}
+
+void ChannelCache::load(const QJsonArray& channels, const QString& tvheadendHost) {
+    QVector<KodiChannel> previous = m_channels;
+    clear();
+    m_channels.reserve(channels.count());
+    for (const QJsonValue& value : channels) {
+        QJsonObject object = value.toObject();
+        KodiChannel channel;
+        channel.channelId = object.value("channelid").toInt();
+        channel.channelNumber = object.value("channelnumber").toInt();
+        channel.uniqueId = object.value("uniqueid").toInt();
+        channel.label = m_strings->intern(object.value("label").toString());
+        channel.image = m_strings->intern(imageUrl(object.value("thumbnail").toString(), tvheadendHost));
+        channel.tvheadendUuid = 0;
+        m_channels.append(channel);
+    }
+    index();
+
+    // interned texts compare by handle
+    m_unchangedCount = 0;
+    while (m_unchangedCount < previous.count() && m_unchangedCount < m_channels.count()) {
+        const KodiChannel& before = previous.at(m_unchangedCount);
+        const KodiChannel& after = m_channels.at(m_unchangedCount);
+        if (before.channelId != after.channelId || before.channelNumber != after.channelNumber ||
+            before.label != after.label || before.image != after.image) {
+            break;
+        }
+        m_unchangedCount++;
+    }
+    if (m_unchangedCount != previous.count() || m_unchangedCount != m_channels.count()) {
+        m_revision++;
+    }
+}
+
+void ChannelCache::setTVHeadendUuid(int channel, const QString& uuid) {
+    int previous = m_channels.at(channel).tvheadendUuid;
+    if (m_byTVHeadendUuid.value(previous, -1) == channel) {
+        m_byTVHeadendUuid.remove(previous);
+    }
+    int handle = m_strings->intern(uuid);
+    m_channels[channel].tvheadendUuid = handle;
+    if (handle != 0) {
+        m_byTVHeadendUuid.insert(handle, channel);
+    }
+}
+
+void ChannelCache::clearTVHeadendUuids() {
+    for (KodiChannel& channel : m_channels) {
+        channel.tvheadendUuid = 0;
+    }
+    m_byTVHeadendUuid.clear();
+}
+
+QByteArray ChannelCache::fingerprint() const {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const KodiChannel& channel : m_channels) {
+        hash.addData(QByteArray::number(channel.channelId) + ':' + QByteArray::number(channel.uniqueId) + ':' +
+                     QByteArray::number(channel.channelNumber) + ':');
+        hash.addData(m_strings->value(channel.label).toUtf8() + '\n');
+    }
+    return hash.result();
+}
+
+QString ChannelCache::imageUrl(const QString& thumbnail, const QString& tvheadendHost) {
+    // Kodi sends the logo as percent encoded image:// URL
+    QString url = QString::fromUtf8(QByteArray::fromPercentEncoding(thumbnail.toUtf8())).mid(8);
+    if (url.contains("127.0.0.1")) {
+        url = url.replace("127.0.0.1", tvheadendHost);
+    }
+    if (url.endsWith('/')) {
+        url = url.chopped(1);
+    }
+    return url;
+}
+
+void ChannelCache::index() {
+    m_byChannelId.clear();
+    m_byChannelNumber.clear();
+    m_byTVHeadendUuid.clear();
+    // the first channel wins if Kodi reports a number twice
+    for (int i = m_channels.count() - 1; i >= 0; i--) {
+        const KodiChannel& channel = m_channels.at(i);
+        m_byChannelId.insert(channel.channelId, i);
+        m_byChannelNumber.insert(channel.channelNumber, i);
+        if (channel.tvheadendUuid != 0) {
+            m_byTVHeadendUuid.insert(channel.tvheadendUuid, i);
+        }
+    }
+}
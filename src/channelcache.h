@@ -0,0 +1,95 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QJsonArray>
+#include <QString>
+#include <QVector>
+
+#include "stringpool.h"
+
+// a channel of a PVR.GetChannels reply, the texts are handles into the string pool of the cache
+struct KodiChannel {
+    int channelId;
+    int channelNumber;
+    // the id the PVR backend gives the channel, it changes when TVHeadend recreates the channel
+    int uniqueId;
+    int label;
+    // the logo URL resolved from the thumbnail Kodi reports
+    int image;
+    // 0 until the channel is mapped to TVHeadend
+    int tvheadendUuid;
+};
+
+// The TV or radio channels of Kodi with hash indexes by channel id, channel number and TVHeadend UUID. Channels are
+// addressed by their index, -1 if a lookup finds nothing.
+class ChannelCache {
+ public:
+    explicit ChannelCache(StringPool* strings = nullptr) : m_strings(strings) {}
+
+    // the pool must outlive the cache and is not cleared with it
+    void setStringPool(StringPool* strings) { m_strings = strings; }
+    // interns all texts of the cache in strings, the caller replaces the pool of the cache with it afterwards
+    void translateStrings(StringPool* strings);
+
+    void clear();
+    // replaces the channels with the "channels" array of a PVR.GetChannels result, logos served by Kodi's local
+    // TVHeadend are addressed by tvheadendHost
+    void load(const QJsonArray& channels, const QString& tvheadendHost);
+    void setTVHeadendUuid(int channel, const QString& uuid);
+    void clearTVHeadendUuids();
+
+    // increases whenever a load changes what is shown of the channels, the UUIDs are not counted
+    int revision() const { return m_revision; }
+    // the number of channels at the front of the list the last load left as they were
+    int unchangedCount() const { return m_unchangedCount; }
+
+    // a hash of the ids, backend ids, numbers and labels of the channels, the TVHeadend mapping is valid as long as it
+    // is the same
+    QByteArray fingerprint() const;
+
+    int                count() const { return m_channels.count(); }
+    const KodiChannel& at(int channel) const { return m_channels.at(channel); }
+    const QString&     label(int channel) const { return m_strings->value(m_channels.at(channel).label); }
+    const QString&     image(int channel) const { return m_strings->value(m_channels.at(channel).image); }
+    const QString&     tvheadendUuid(int channel) const {
+        return m_strings->value(m_channels.at(channel).tvheadendUuid);
+    }
+
+    int byChannelId(int channelId) const { return m_byChannelId.value(channelId, -1); }
+    int byChannelNumber(int channelNumber) const { return m_byChannelNumber.value(channelNumber, -1); }
+    int byTVHeadendUuid(int uuidHandle) const { return m_byTVHeadendUuid.value(uuidHandle, -1); }
+
+ private:
+    void           index();
+    static QString imageUrl(const QString& thumbnail, const QString& tvheadendHost);
+
+    StringPool*          m_strings;
+    QVector<KodiChannel> m_channels;
+    QHash<int, int>      m_byChannelId;
+    QHash<int, int>      m_byChannelNumber;
+    QHash<int, int>      m_byTVHeadendUuid;
+    int                  m_revision = 0;
+    int                  m_unchangedCount = 0;
+};
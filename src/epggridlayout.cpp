@@ -0,0 +1,62 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#include "epggridlayout.h"
+
+#include <QDateTime>
+
+EpgGridLayout::EpgGridLayout(uint origin, int width) : m_origin(origin), m_width(width) {}
+
+QVector<uint> EpgGridLayout::hours() const {
+    const int     hourWidth = 60 * PIXELS_PER_MINUTE;
+    QVector<uint> result;
+    // only hours fitting completely on the time axis get a cell
+    for (int x = 0; x + hourWidth <= m_width; x += hourWidth) {
+        result.append(timeAt(x));
+    }
+    return result;
+}
+
+QString EpgGridLayout::hourLabel(uint hour) const {
+    QDateTime timestamp = QDateTime::fromTime_t(hour);
+    return QString::number(timestamp.time().hour()) + " Uhr  " + QString::number(timestamp.date().day()) + "." +
+           QString::number(timestamp.date().month()) + "." + QString::number(timestamp.date().year());
+}
+
+bool EpgGridLayout::eventCell(uint start, uint stop, int* x, int* width) const {
+    int from = xAt(start);
+    int to = xAt(stop);
+    if (to <= from) {
+        return false;
+    }
+    *x = LABEL_WIDTH + from;
+    *width = to - from;
+    return true;
+}
+
+int EpgGridLayout::xAt(uint time) const {
+    // times before the origin are clamped to it, times far ahead to the end of the axis
+    if (time <= m_origin) {
+        return 0;
+    }
+    return static_cast<int>(qMin<qint64>((time - m_origin) / 60 * PIXELS_PER_MINUTE, m_width));
+}
@@ -0,0 +1,56 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#pragma once
+#include <QString>
+#include <QVector>
+
+// Geometry of the EPG grid: a header row with one cell per hour, a column of channel labels and one row per channel.
+// Times are mapped to pixels from the origin, events are clipped to the time axis.
+class EpgGridLayout {
+ public:
+    static const int PIXELS_PER_MINUTE = 6;
+    static const int LABEL_WIDTH = 170;
+    static const int ROW_HEIGHT = 40;
+
+    // origin is the time at the left edge of the time axis, width the length of the time axis in pixels
+    EpgGridLayout(uint origin, int width);
+
+    // times at both ends of the time axis
+    uint start() const { return m_origin; }
+    uint end() const { return timeAt(m_width); }
+
+    // start times of the hours whose header cell fits on the time axis
+    QVector<uint> hours() const;
+    int           hourX(uint hour) const { return LABEL_WIDTH + xAt(hour); }
+    QString       hourLabel(uint hour) const;
+
+    // geometry of an event clipped to the time axis, false if the event lies outside of it
+    bool eventCell(uint start, uint stop, int* x, int* width) const;
+
+ private:
+    int  xAt(uint time) const;
+    uint timeAt(int x) const { return m_origin + static_cast<uint>(x / PIXELS_PER_MINUTE) * 60; }
+
+    uint m_origin;
+    int  m_width;
+};
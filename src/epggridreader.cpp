@@ -0,0 +1,357 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#include "epggridreader.h"
+
+#include <cstring>
+
+static bool keyEquals(const char* key, int length, const char* name) {
+    return static_cast<int>(strlen(name)) == length && memcmp(key, name, length) == 0;
+}
+
+static void appendUtf8(QByteArray* out, uint code) {
+    if (code < 0x80) {
+        out->append(static_cast<char>(code));
+    } else if (code < 0x800) {
+        out->append(static_cast<char>(0xc0 | (code >> 6)));
+        out->append(static_cast<char>(0x80 | (code & 0x3f)));
+    } else if (code < 0x10000) {
+        out->append(static_cast<char>(0xe0 | (code >> 12)));
+        out->append(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+        out->append(static_cast<char>(0x80 | (code & 0x3f)));
+    } else {
+        out->append(static_cast<char>(0xf0 | (code >> 18)));
+        out->append(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+        out->append(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+        out->append(static_cast<char>(0x80 | (code & 0x3f)));
+    }
+}
+
+static bool readHex4(const char* p, uint* code) {
+    *code = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        *code <<= 4;
+        if (c >= '0' && c <= '9') {
+            *code |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            *code |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            *code |= c - 'A' + 10;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EpgGridReader::read(const QByteArray& reply, const EventHandler& handler) {
+    m_pos = reply.constData();
+    m_end = m_pos + reply.size();
+    m_totalCount = 0;
+
+    // {"entries": [...], "totalCount": n}
+    if (!consume('{')) {
+        return false;
+    }
+    if (consume('}')) {
+        return true;
+    }
+    do {
+        const char* key;
+        int         length;
+        if (!readKey(&key, &length)) {
+            return false;
+        }
+        if (keyEquals(key, length, "entries")) {
+            if (!readEntries(handler)) {
+                return false;
+            }
+        } else if (keyEquals(key, length, "totalCount")) {
+            qint64 totalCount;
+            if (!readInteger(&totalCount)) {
+                return false;
+            }
+            m_totalCount = static_cast<int>(totalCount);
+        } else if (!skipValue()) {
+            return false;
+        }
+    } while (consume(','));
+    return consume('}');
+}
+
+bool EpgGridReader::readEntries(const EventHandler& handler) {
+    if (!consume('[')) {
+        return false;
+    }
+    if (consume(']')) {
+        return true;
+    }
+    do {
+        if (!skipWhitespace()) {
+            return false;
+        }
+        if (*m_pos == '{') {
+            if (!readEvent()) {
+                return false;
+            }
+            handler(m_event);
+        } else if (!skipValue()) {
+            return false;
+        }
+    } while (consume(','));
+    return consume(']');
+}
+
+bool EpgGridReader::readEvent() {
+    m_event.eventId = 0;
+    m_event.channelUuid.clear();
+    m_event.channelNumber.clear();
+    m_event.channelIcon.clear();
+    m_event.start = 0;
+    m_event.stop = 0;
+    m_event.title.clear();
+    m_event.subtitle.clear();
+    m_event.description.clear();
+
+    if (!consume('{')) {
+        return false;
+    }
+    if (consume('}')) {
+        return true;
+    }
+    do {
+        const char* key;
+        int         length;
+        if (!readKey(&key, &length)) {
+            return false;
+        }
+        bool ok;
+        if (keyEquals(key, length, "eventId")) {
+            qint64 eventId;
+            ok = readInteger(&eventId);
+            m_event.eventId = static_cast<int>(eventId);
+        } else if (keyEquals(key, length, "start")) {
+            ok = readInteger(&m_event.start);
+        } else if (keyEquals(key, length, "stop")) {
+            ok = readInteger(&m_event.stop);
+        } else if (keyEquals(key, length, "channelUuid")) {
+            ok = readString(&m_event.channelUuid);
+        } else if (keyEquals(key, length, "channelNumber")) {
+            ok = readString(&m_event.channelNumber);
+        } else if (keyEquals(key, length, "channelIcon")) {
+            ok = readString(&m_event.channelIcon);
+        } else if (keyEquals(key, length, "title")) {
+            ok = readString(&m_event.title);
+        } else if (keyEquals(key, length, "subtitle")) {
+            ok = readString(&m_event.subtitle);
+        } else if (keyEquals(key, length, "description")) {
+            ok = readString(&m_event.description);
+        } else {
+            ok = skipValue();
+        }
+        if (!ok) {
+            return false;
+        }
+    } while (consume(','));
+    return consume('}');
+}
+
+bool EpgGridReader::readKey(const char** key, int* length) {
+    // member names of the grid never contain escapes, a name with escapes simply matches nothing
+    if (!skipWhitespace() || *m_pos != '"') {
+        return false;
+    }
+    *key = m_pos + 1;
+    if (!skipString()) {
+        return false;
+    }
+    *length = static_cast<int>(m_pos - 1 - *key);
+    return consume(':');
+}
+
+bool EpgGridReader::readString(QString* value) {
+    if (!skipWhitespace()) {
+        return false;
+    }
+    if (*m_pos != '"') {
+        // null or an unexpected type, the field stays empty
+        return skipValue();
+    }
+    const char* begin = ++m_pos;
+    const char* p = begin;
+    while (p < m_end && *p != '"' && *p != '\\') {
+        p++;
+    }
+    if (p < m_end && *p == '"') {
+        *value = QString::fromUtf8(begin, static_cast<int>(p - begin));
+        m_pos = p + 1;
+        return true;
+    }
+
+    // slow path for strings with escapes, resize(0) keeps the reserved capacity
+    if (m_scratch.capacity() < 1024) {
+        m_scratch.reserve(1024);
+    }
+    m_scratch.resize(0);
+    m_scratch.append(begin, static_cast<int>(p - begin));
+    while (p < m_end && *p != '"') {
+        if (*p != '\\') {
+            m_scratch.append(*p++);
+            continue;
+        }
+        if (++p >= m_end) {
+            return false;
+        }
+        char c = *p++;
+        switch (c) {
+            case 'b':
+                m_scratch.append('\b');
+                break;
+            case 'f':
+                m_scratch.append('\f');
+                break;
+            case 'n':
+                m_scratch.append('\n');
+                break;
+            case 'r':
+                m_scratch.append('\r');
+                break;
+            case 't':
+                m_scratch.append('\t');
+                break;
+            case 'u': {
+                uint code;
+                if (m_end - p < 4 || !readHex4(p, &code)) {
+                    return false;
+                }
+                p += 4;
+                // characters outside the BMP are sent as surrogate pair
+                uint low;
+                if (code >= 0xd800 && code < 0xdc00 && m_end - p >= 6 && p[0] == '\\' && p[1] == 'u' &&
+                    readHex4(p + 2, &low) && low >= 0xdc00 && low < 0xe000) {
+                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                    p += 6;
+                }
+                appendUtf8(&m_scratch, code);
+                break;
+            }
+            default:
+                m_scratch.append(c);
+        }
+    }
+    if (p >= m_end) {
+        return false;
+    }
+    *value = QString::fromUtf8(m_scratch);
+    m_pos = p + 1;
+    return true;
+}
+
+bool EpgGridReader::readInteger(qint64* value) {
+    if (!skipWhitespace()) {
+        return false;
+    }
+    bool negative = *m_pos == '-';
+    if (negative) {
+        m_pos++;
+    }
+    if (m_pos >= m_end || *m_pos < '0' || *m_pos > '9') {
+        // null or an unexpected type
+        *value = 0;
+        return skipValue();
+    }
+    qint64 result = 0;
+    while (m_pos < m_end && *m_pos >= '0' && *m_pos <= '9') {
+        result = result * 10 + (*m_pos++ - '0');
+    }
+    *value = negative ? -result : result;
+    // a fraction or exponent is cut off
+    while (m_pos < m_end && (*m_pos == '.' || *m_pos == 'e' || *m_pos == 'E' || *m_pos == '+' || *m_pos == '-' ||
+                             (*m_pos >= '0' && *m_pos <= '9'))) {
+        m_pos++;
+    }
+    return true;
+}
+
+bool EpgGridReader::skipString() {
+    // m_pos is on the opening quote
+    for (const char* p = m_pos + 1; p < m_end; p++) {
+        if (*p == '\\') {
+            p++;
+        } else if (*p == '"') {
+            m_pos = p + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EpgGridReader::skipValue() {
+    if (!skipWhitespace()) {
+        return false;
+    }
+    if (*m_pos == '"') {
+        return skipString();
+    }
+    if (*m_pos != '{' && *m_pos != '[') {
+        // number, true, false or null
+        const char* begin = m_pos;
+        while (m_pos < m_end && *m_pos != ',' && *m_pos != '}' && *m_pos != ']' && *m_pos != ' ' &&
+               *m_pos != '\t' && *m_pos != '\r' && *m_pos != '\n') {
+            m_pos++;
+        }
+        return m_pos > begin;
+    }
+    int depth = 0;
+    while (m_pos < m_end) {
+        char c = *m_pos;
+        if (c == '"') {
+            if (!skipString()) {
+                return false;
+            }
+            continue;
+        }
+        m_pos++;
+        if (c == '{' || c == '[') {
+            depth++;
+        } else if ((c == '}' || c == ']') && --depth == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EpgGridReader::skipWhitespace() {
+    while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\r' || *m_pos == '\n')) {
+        m_pos++;
+    }
+    return m_pos < m_end;
+}
+
+bool EpgGridReader::consume(char c) {
+    if (skipWhitespace() && *m_pos == c) {
+        m_pos++;
+        return true;
+    }
+    return false;
+}
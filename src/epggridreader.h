@@ -0,0 +1,69 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <functional>
+
+// the fields of a TVHeadend EPG event which are shown by the integration
+struct EpgEvent {
+    int     eventId;
+    QString channelUuid;
+    QString channelNumber;
+    QString channelIcon;
+    qint64  start;
+    qint64  stop;
+    QString title;
+    QString subtitle;
+    QString description;
+};
+
+// Reads a TVHeadend /api/epg/events/grid reply in a single pass over the received bytes. Only the members of EpgEvent
+// are decoded, everything else is skipped without building a QJsonDocument or QVariantMaps.
+class EpgGridReader {
+ public:
+    typedef std::function<void(const EpgEvent&)> EventHandler;
+
+    // calls handler for every entry, the event is reused for the next entry. Returns false if the reply is malformed,
+    // the entries read until then have already been handed out.
+    bool read(const QByteArray& reply, const EventHandler& handler);
+    int  totalCount() const { return m_totalCount; }
+
+ private:
+    bool readEntries(const EventHandler& handler);
+    bool readEvent();
+    bool readKey(const char** key, int* length);
+    bool readString(QString* value);
+    bool readInteger(qint64* value);
+    bool skipString();
+    bool skipValue();
+    bool skipWhitespace();
+    bool consume(char c);
+
+    const char* m_pos = nullptr;
+    const char* m_end = nullptr;
+    int         m_totalCount = 0;
+    EpgEvent    m_event;
+    // unescaped string bytes, keeps its capacity between strings
+    QByteArray m_scratch;
+};
@@ -0,0 +1,299 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#include "epgstore.h"
+
+#include <algorithm>
+
+// "YEPG" and the layout version of the snapshot
+static const quint32 SNAPSHOT_MAGIC = 0x59455047;
+static const quint32 SNAPSHOT_VERSION = 2;
+
+void EpgStore::translateStrings(StringPool* strings) {
+    // every handle of the current pool is looked up only once
+    QVector<int> handles(m_strings->count(), -1);
+    auto         translate = [&](int* handle) {
+        if (handles.at(*handle) < 0) {
+            handles[*handle] = strings->intern(m_strings->value(*handle));
+        }
+        *handle = handles.at(*handle);
+    };
+    for (QVector<int>* column : {&m_title, &m_subtitle, &m_description, &m_channelUuid, &m_channelNumber,
+                                 &m_channelIcon}) {
+        for (int i = 0; i < column->count(); i++) {
+            translate(&(*column)[i]);
+        }
+    }
+    m_channelByUuid.clear();
+    for (int channel = 0; channel < channelCount(); channel++) {
+        m_channelByUuid.insert(m_channelUuid.at(channel), channel);
+    }
+}
+
+void EpgStore::clear() {
+    m_eventId.clear();
+    m_channel.clear();
+    m_start.clear();
+    m_stop.clear();
+    m_title.clear();
+    m_subtitle.clear();
+    m_description.clear();
+    m_channelUuid.clear();
+    m_channelNumber.clear();
+    m_channelIcon.clear();
+    m_channelEvents.clear();
+    m_channelMaxStop.clear();
+    m_channelByUuid.clear();
+    m_eventByEventId.clear();
+}
+
+void EpgStore::add(const EpgEvent& event) {
+    int channel = channelByUuid(event.channelUuid);
+    if (channel < 0) {
+        channel = addChannel(event);
+    }
+    int index = m_eventByEventId.value(event.eventId, -1);
+    if (index >= 0) {
+        // a refreshed event replaces the stored one, texts it no longer uses stay pooled until the pool is compacted
+        removeFromChannel(index);
+        m_channel[index] = channel;
+        m_start[index] = static_cast<uint>(event.start);
+        m_stop[index] = static_cast<uint>(event.stop);
+        m_title[index] = m_strings->intern(event.title);
+        m_subtitle[index] = m_strings->intern(event.subtitle);
+        m_description[index] = m_strings->intern(event.description);
+    } else {
+        index = m_start.count();
+        m_eventId.append(event.eventId);
+        m_channel.append(channel);
+        m_start.append(static_cast<uint>(event.start));
+        m_stop.append(static_cast<uint>(event.stop));
+        m_title.append(m_strings->intern(event.title));
+        m_subtitle.append(m_strings->intern(event.subtitle));
+        m_description.append(m_strings->intern(event.description));
+        m_eventByEventId.insert(event.eventId, index);
+    }
+    insertIntoChannel(index);
+}
+
+int EpgStore::evict(uint before) {
+    int removed = 0;
+    for (uint stop : m_stop) {
+        if (stop < before) {
+            removed++;
+        }
+    }
+    if (removed == 0) {
+        return 0;
+    }
+    // rebuilding drops the indexes and the channels of the removed events as well
+    EpgStore kept(m_strings);
+    for (int i = 0; i < count(); i++) {
+        if (m_stop.at(i) >= before) {
+            kept.add(event(i));
+        }
+    }
+    *this = kept;
+    return removed;
+}
+
+void EpgStore::write(QDataStream* out) const {
+    *out << SNAPSHOT_MAGIC << SNAPSHOT_VERSION;
+    // the pooled texts in order of their handles, handle 0 is always the empty string
+    *out << static_cast<quint32>(m_strings->count() - 1);
+    for (int handle = 1; handle < m_strings->count(); handle++) {
+        *out << m_strings->value(handle);
+    }
+    *out << m_channelUuid << m_channelNumber << m_channelIcon;
+    *out << m_eventId << m_channel << m_start << m_stop << m_title << m_subtitle << m_description;
+}
+
+bool EpgStore::read(QDataStream* in) {
+    clear();
+    quint32 magic = 0;
+    quint32 version = 0;
+    *in >> magic >> version;
+    if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) {
+        return false;
+    }
+    // the handles of the snapshot are translated to handles of the shared pool
+    quint32 strings = 0;
+    *in >> strings;
+    QVector<int> handles = {0};
+    for (quint32 i = 0; i < strings && in->status() == QDataStream::Ok; i++) {
+        QString text;
+        *in >> text;
+        handles.append(m_strings->intern(text));
+    }
+    *in >> m_channelUuid >> m_channelNumber >> m_channelIcon;
+    *in >> m_eventId >> m_channel >> m_start >> m_stop >> m_title >> m_subtitle >> m_description;
+
+    // a truncated or damaged file must not leave indexes pointing outside the columns
+    bool valid = in->status() == QDataStream::Ok && handles.count() == static_cast<int>(strings) + 1 &&
+                 m_channelNumber.count() == channelCount() && m_channelIcon.count() == channelCount() &&
+                 m_eventId.count() == count() && m_channel.count() == count() && m_stop.count() == count() &&
+                 m_title.count() == count() && m_subtitle.count() == count() && m_description.count() == count();
+    for (QVector<int>* column : {&m_title, &m_subtitle, &m_description, &m_channelUuid, &m_channelNumber,
+                                 &m_channelIcon}) {
+        for (int i = 0; valid && i < column->count(); i++) {
+            int& handle = (*column)[i];
+            valid = handle >= 0 && handle < handles.count();
+            handle = valid ? handles.at(handle) : 0;
+        }
+    }
+    for (int i = 0; valid && i < count(); i++) {
+        valid = m_channel.at(i) >= 0 && m_channel.at(i) < channelCount();
+    }
+    if (!valid) {
+        clear();
+        return false;
+    }
+    for (int channel = 0; channel < channelCount(); channel++) {
+        m_channelEvents.append(QVector<int>());
+        m_channelMaxStop.append(QVector<uint>());
+        m_channelByUuid.insert(m_channelUuid.at(channel), channel);
+    }
+    for (int i = 0; i < count(); i++) {
+        m_eventByEventId.insert(m_eventId.at(i), i);
+        insertIntoChannel(i);
+    }
+    return true;
+}
+
+qint64 EpgStore::footprint() const {
+    qint64 bytes = count() * static_cast<qint64>(5 * sizeof(int) + 2 * sizeof(uint));
+    // channel index, running maximum and event id hash
+    bytes += count() * static_cast<qint64>(sizeof(int) + sizeof(uint) + 2 * sizeof(int));
+    // channel columns, their hashes and the shared pool the texts live in
+    bytes += channelCount() * static_cast<qint64>(7 * sizeof(int));
+    return bytes + m_strings->bytes();
+}
+
+EpgEvent EpgStore::event(int event) const {
+    EpgEvent result;
+    int      channel = m_channel.at(event);
+    result.eventId = m_eventId.at(event);
+    result.channelUuid = channelUuid(channel);
+    result.channelNumber = channelNumber(channel);
+    result.channelIcon = channelIcon(channel);
+    result.start = m_start.at(event);
+    result.stop = m_stop.at(event);
+    result.title = title(event);
+    result.subtitle = subtitle(event);
+    result.description = description(event);
+    return result;
+}
+
+int EpgStore::channelByUuid(const QString& uuid) const {
+    int handle = m_strings->handle(uuid);
+    return handle < 0 ? -1 : m_channelByUuid.value(handle, -1);
+}
+
+int EpgStore::eventAt(int channel, uint time) const {
+    // the latest event starting at or before time is the only candidate, overlaps are resolved in its favour
+    int position = firstStartingAfter(channel, time) - 1;
+    if (position < 0) {
+        return -1;
+    }
+    int event = m_channelEvents.at(channel).at(position);
+    return m_stop.at(event) > time ? event : -1;
+}
+
+QVector<int> EpgStore::nextEvents(int channel, uint time, int count) const {
+    const QVector<int>& events = m_channelEvents.at(channel);
+    int                 position = firstStartingAfter(channel, time);
+    return events.mid(position, count);
+}
+
+QVector<int> EpgStore::eventsBetween(int channel, uint from, uint to) const {
+    const QVector<int>& events = m_channelEvents.at(channel);
+    QVector<int>        result;
+    int                 end = firstStartingAfter(channel, to > 0 ? to - 1 : 0);
+    for (int i = firstEndingAfter(channel, from); i < end; i++) {
+        // an earlier long event can keep the running maximum up, skip the short ones it covers
+        if (m_stop.at(events.at(i)) > from) {
+            result.append(events.at(i));
+        }
+    }
+    return result;
+}
+
+int EpgStore::firstStartingAfter(int channel, uint time) const {
+    const QVector<int>& events = m_channelEvents.at(channel);
+    auto                byStart = [this](uint value, int event) { return value < m_start.at(event); };
+    return static_cast<int>(std::upper_bound(events.begin(), events.end(), time, byStart) - events.begin());
+}
+
+int EpgStore::firstEndingAfter(int channel, uint time) const {
+    const QVector<uint>& maxStop = m_channelMaxStop.at(channel);
+    return static_cast<int>(std::upper_bound(maxStop.begin(), maxStop.end(), time) - maxStop.begin());
+}
+
+int EpgStore::addChannel(const EpgEvent& event) {
+    int channel = m_channelUuid.count();
+    int uuid = m_strings->intern(event.channelUuid);
+    m_channelUuid.append(uuid);
+    m_channelNumber.append(m_strings->intern(event.channelNumber));
+    m_channelIcon.append(m_strings->intern(event.channelIcon));
+    m_channelEvents.append(QVector<int>());
+    m_channelMaxStop.append(QVector<uint>());
+    m_channelByUuid.insert(uuid, channel);
+    return channel;
+}
+
+void EpgStore::insertIntoChannel(int event) {
+    int channel = m_channel.at(event);
+    // TVHeadend sends the events of a channel in order, so this is an append in almost all cases
+    QVector<int>& events = m_channelEvents[channel];
+    auto          byStart = [this](int a, int b) { return m_start.at(a) < m_start.at(b); };
+
+    int position = static_cast<int>(std::upper_bound(events.begin(), events.end(), event, byStart) - events.begin());
+    events.insert(position, event);
+    m_channelMaxStop[channel].insert(position, 0);
+    updateMaxStop(channel, position);
+}
+
+void EpgStore::removeFromChannel(int event) {
+    int           channel = m_channel.at(event);
+    QVector<int>& events = m_channelEvents[channel];
+    auto          byStart = [this](int a, int b) { return m_start.at(a) < m_start.at(b); };
+    auto          it = std::lower_bound(events.begin(), events.end(), event, byStart);
+    while (it != events.end() && *it != event) {
+        ++it;
+    }
+    if (it == events.end()) {
+        return;
+    }
+    int position = static_cast<int>(it - events.begin());
+    events.remove(position);
+    m_channelMaxStop[channel].remove(position);
+    updateMaxStop(channel, position);
+}
+
+void EpgStore::updateMaxStop(int channel, int position) {
+    // the running maximum only changes from the given position on
+    const QVector<int>& events = m_channelEvents.at(channel);
+    QVector<uint>&      maxStop = m_channelMaxStop[channel];
+    for (int i = position; i < events.count(); i++) {
+        maxStop[i] = qMax(i > 0 ? maxStop.at(i - 1) : 0, m_stop.at(events.at(i)));
+    }
+}
@@ -0,0 +1,115 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#pragma once
+#include <QDataStream>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "epggridreader.h"
+#include "stringpool.h"
+
+// EPG events stored column by column. Texts are interned in a string pool shared with the rest of the integration, the
+// channel attributes are kept once per channel and the events of every channel are indexed in order of their start
+// time together with the running maximum of their stop times, which answers the time queries below with binary
+// searches. Events are addressed by their index, which stays valid until the next evict() or clear(). Anything kept
+// longer, like the items of a shown grid, refers to the TVHeadend event id instead.
+class EpgStore {
+ public:
+    explicit EpgStore(StringPool* strings = nullptr) : m_strings(strings) {}
+
+    // the pool must outlive the store and is not cleared with it
+    void setStringPool(StringPool* strings) { m_strings = strings; }
+    // interns all texts of the store in strings, the caller replaces the pool of the store with it afterwards
+    void translateStrings(StringPool* strings);
+
+    void clear();
+    // adds the event or replaces the stored event with the same event id
+    void add(const EpgEvent& event);
+    // removes the events which stopped before time and compacts the store, returns the number of removed events
+    int  evict(uint before);
+
+    int count() const { return m_start.count(); }
+    // index of the event with a TVHeadend event id, -1 if it is not stored
+    int byEventId(int eventId) const { return m_eventByEventId.value(eventId, -1); }
+
+    // versioned binary snapshot, read() leaves the store empty if the data is no snapshot of this version
+    void write(QDataStream* out) const;
+    bool read(QDataStream* in);
+
+    // approximate number of bytes held by the store
+    qint64   footprint() const;
+    EpgEvent event(int event) const;
+
+    // event columns
+    int            eventId(int event) const { return m_eventId.at(event); }
+    int            channel(int event) const { return m_channel.at(event); }
+    uint           start(int event) const { return m_start.at(event); }
+    uint           stop(int event) const { return m_stop.at(event); }
+    const QString& title(int event) const { return m_strings->value(m_title.at(event)); }
+    const QString& subtitle(int event) const { return m_strings->value(m_subtitle.at(event)); }
+    const QString& description(int event) const { return m_strings->value(m_description.at(event)); }
+
+    // channels, -1 if the channel has no events
+    int            channelCount() const { return m_channelUuid.count(); }
+    int            channelByUuid(const QString& uuid) const;
+    int            channelUuidHandle(int channel) const { return m_channelUuid.at(channel); }
+    const QString& channelUuid(int channel) const { return m_strings->value(m_channelUuid.at(channel)); }
+    const QString& channelNumber(int channel) const { return m_strings->value(m_channelNumber.at(channel)); }
+    const QString& channelIcon(int channel) const { return m_strings->value(m_channelIcon.at(channel)); }
+    // event indexes of a channel sorted by start time
+    const QVector<int>& channelEvents(int channel) const { return m_channelEvents.at(channel); }
+
+    // event running at time on a channel, -1 if there is none
+    int          eventAt(int channel, uint time) const;
+    // at most count events of a channel starting after time, sorted by start time
+    QVector<int> nextEvents(int channel, uint time, int count) const;
+    // events of a channel overlapping [from, to), sorted by start time
+    QVector<int> eventsBetween(int channel, uint from, uint to) const;
+
+ private:
+    int  addChannel(const EpgEvent& event);
+    void insertIntoChannel(int event);
+    void removeFromChannel(int event);
+    void updateMaxStop(int channel, int position);
+    int  firstStartingAfter(int channel, uint time) const;
+    int  firstEndingAfter(int channel, uint time) const;
+
+    QVector<int>  m_eventId;
+    QVector<int>  m_channel;
+    QVector<uint> m_start;
+    QVector<uint> m_stop;
+    QVector<int>  m_title;
+    QVector<int>  m_subtitle;
+    QVector<int>  m_description;
+    StringPool*   m_strings;
+
+    // text columns of the channels hold string handles, the hashes are keyed by them as well
+    QVector<int>           m_channelUuid;
+    QVector<int>           m_channelNumber;
+    QVector<int>           m_channelIcon;
+    QVector<QVector<int>>  m_channelEvents;
+    QVector<QVector<uint>> m_channelMaxStop;
+    QHash<int, int>        m_channelByUuid;
+    QHash<int, int>        m_eventByEventId;
+};
@@ -0,0 +1,133 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#include "jsonrpcrequest.h"
+
+JsonRpcRequest::JsonRpcRequest(const QByteArray& method, const QByteArray& params) : m_method(method) {
+    // {"jsonrpc":"2.0","method":"<method>","params":<params>,"id":
+    m_prefix.reserve(48 + method.size() + params.size());
+    m_prefix.append("{\"jsonrpc\":\"2.0\",\"method\":\"");
+    m_prefix.append(method);
+    m_prefix.append("\",\"params\":");
+    m_prefix.append(params);
+    m_prefix.append(",\"id\":");
+}
+
+QByteArray JsonRpcRequest::body(int id) const {
+    char  digits[12];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    // ids are positive and increasing, see Kodi::registerKodiRequest()
+    do {
+        *--p = static_cast<char>('0' + id % 10);
+        id /= 10;
+    } while (id > 0);
+
+    QByteArray body;
+    body.reserve(m_prefix.size() + static_cast<int>(end - p) + 1);
+    body.append(m_prefix);
+    body.append(p, static_cast<int>(end - p));
+    body.append('}');
+    return body;
+}
+
+JsonRpcParams& JsonRpcParams::begin() {
+    // resize(0) only keeps the memory of a buffer with reserved capacity
+    if (m_buffer.capacity() < 256) {
+        m_buffer.reserve(256);
+    }
+    m_buffer.resize(0);
+    m_buffer.append('{');
+    return *this;
+}
+
+JsonRpcParams& JsonRpcParams::add(const char* key, int value) {
+    addKey(key);
+    m_buffer.append(QByteArray::number(value));
+    return *this;
+}
+
+JsonRpcParams& JsonRpcParams::add(const char* key, const QString& value) {
+    static const char hex[] = "0123456789abcdef";
+    addKey(key);
+    m_buffer.append('"');
+    for (char c : value.toUtf8()) {
+        switch (c) {
+            case '"':
+                m_buffer.append("\\\"");
+                break;
+            case '\\':
+                m_buffer.append("\\\\");
+                break;
+            case '\n':
+                m_buffer.append("\\n");
+                break;
+            case '\r':
+                m_buffer.append("\\r");
+                break;
+            case '\t':
+                m_buffer.append("\\t");
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    m_buffer.append("\\u00");
+                    m_buffer.append(hex[(c >> 4) & 0xf]);
+                    m_buffer.append(hex[c & 0xf]);
+                } else {
+                    m_buffer.append(c);
+                }
+        }
+    }
+    m_buffer.append('"');
+    return *this;
+}
+
+JsonRpcParams& JsonRpcParams::addRaw(const char* key, const char* json) {
+    addKey(key);
+    m_buffer.append(json);
+    return *this;
+}
+
+JsonRpcParams& JsonRpcParams::beginObject(const char* key) {
+    addKey(key);
+    m_buffer.append('{');
+    return *this;
+}
+
+JsonRpcParams& JsonRpcParams::endObject() {
+    m_buffer.append('}');
+    return *this;
+}
+
+const QByteArray& JsonRpcParams::end() {
+    m_buffer.append('}');
+    return m_buffer;
+}
+
+void JsonRpcParams::addKey(const char* key) {
+    if (!m_buffer.endsWith('{')) {
+        m_buffer.append(',');
+    }
+    m_buffer.append('"');
+    m_buffer.append(key);
+    m_buffer.append("\":");
+}
@@ -0,0 +1,61 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#pragma once
+#include <QByteArray>
+#include <QString>
+
+// A Kodi JSON-RPC request encoded as UTF-8 up to its id. Requests without changing parameters are created once and
+// reused, only the id is appended for every call.
+class JsonRpcRequest {
+ public:
+    JsonRpcRequest() {}
+    explicit JsonRpcRequest(const QByteArray& method, const QByteArray& params = "{}");
+
+    const QByteArray& method() const { return m_method; }
+    // the complete request with the given id
+    QByteArray body(int id) const;
+
+ private:
+    QByteArray m_method;
+    QByteArray m_prefix;
+};
+
+// Renders request parameters into a buffer which keeps its capacity between requests. Keys are expected to be plain
+// ASCII, string values are escaped.
+class JsonRpcParams {
+ public:
+    JsonRpcParams& begin();
+    JsonRpcParams& add(const char* key, int value);
+    JsonRpcParams& add(const char* key, const QString& value);
+    // adds a value which is already valid JSON, e.g. a constant list of properties
+    JsonRpcParams& addRaw(const char* key, const char* json);
+    JsonRpcParams& beginObject(const char* key);
+    JsonRpcParams& endObject();
+    // closes the parameter object, the result is valid until the next begin()
+    const QByteArray& end();
+
+ private:
+    void addKey(const char* key);
+
+    QByteArray m_buffer;
+};
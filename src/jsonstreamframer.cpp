@@ -0,0 +1,81 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#include "jsonstreamframer.h"
+
+void JsonStreamFramer::append(const QByteArray& data) {
+    // drop the already returned messages before the buffer grows
+    if (m_start > 0) {
+        m_buffer.remove(0, m_start);
+        m_pos -= m_start;
+        m_start = 0;
+    }
+    m_buffer.append(data);
+}
+
+QByteArray JsonStreamFramer::next() {
+    const char* data = m_buffer.constData();
+    const int   size = m_buffer.size();
+
+    while (m_pos < size) {
+        char c = data[m_pos++];
+        if (m_depth == 0) {
+            // only whitespace is expected between messages, everything else is skipped
+            if (c == '{' || c == '[') {
+                m_start = m_pos - 1;
+                m_depth = 1;
+            }
+        } else if (m_inString) {
+            if (m_escape) {
+                m_escape = false;
+            } else if (c == '\\') {
+                m_escape = true;
+            } else if (c == '"') {
+                m_inString = false;
+            }
+        } else if (c == '"') {
+            m_inString = true;
+        } else if (c == '{' || c == '[') {
+            m_depth++;
+        } else if (c == '}' || c == ']') {
+            if (--m_depth == 0) {
+                int start = m_start;
+                m_start = m_pos;
+                return QByteArray::fromRawData(data + start, m_pos - start);
+            }
+        }
+    }
+    if (m_depth == 0) {
+        // skipped bytes can be dropped with the next append()
+        m_start = m_pos;
+    }
+    return QByteArray();
+}
+
+void JsonStreamFramer::clear() {
+    m_buffer.clear();
+    m_start = 0;
+    m_pos = 0;
+    m_depth = 0;
+    m_inString = false;
+    m_escape = false;
+}
@@ -0,0 +1,48 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#pragma once
+#include <QByteArray>
+
+// Splits a stream of concatenated JSON-RPC messages (as sent by Kodi over the TCP socket) into complete top level
+// objects or arrays. Partial messages stay in the buffer until the rest arrives. The scan state is kept between
+// calls, so every byte is only looked at once.
+class JsonStreamFramer {
+ public:
+    // appends received bytes, messages returned by next() are invalid afterwards
+    void append(const QByteArray& data);
+
+    // returns the next complete message or a null QByteArray if there is none yet. The returned array references
+    // the internal buffer without copying and is valid until the next call of append() or clear().
+    QByteArray next();
+
+    void clear();
+    int  bufferedBytes() const { return m_buffer.size() - m_start; }
+
+ private:
+    QByteArray m_buffer;
+    int        m_start = 0;  // first byte of the message which is scanned
+    int        m_pos = 0;    // next byte to scan
+    int        m_depth = 0;
+    bool       m_inString = false;
+    bool       m_escape = false;
+};
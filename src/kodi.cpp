@@ -28,15 +28,126 @@
 #include <QDate>
 #include <QDir>
 #include <QFile>
+#include <QFutureWatcher>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QNetworkInterface>
 #include <QProcess>
+#include <QSaveFile>
 #include <QTcpSocket>
 #include <QTextCodec>
+#include <QThread>
 #include <QUrlQuery>
 #include <QXmlStreamReader>
+#include <QtConcurrent>
+
+// requests without changing parameters are encoded only once
+static const JsonRpcRequest KODI_PING("JSONRPC.Ping");
+static const JsonRpcRequest KODI_GET_ACTIVE_PLAYERS("Player.GetActivePlayers");
+static const JsonRpcRequest KODI_INPUT_UP("Input.Up");
+static const JsonRpcRequest KODI_INPUT_DOWN("Input.Down");
+static const JsonRpcRequest KODI_INPUT_LEFT("Input.Left");
+static const JsonRpcRequest KODI_INPUT_RIGHT("Input.Right");
+static const JsonRpcRequest KODI_INPUT_SELECT("Input.Select");
+static const JsonRpcRequest KODI_INPUT_BACK("Input.Back");
+static const JsonRpcRequest KODI_INPUT_CONTEXTMENU("Input.ContextMenu");
+static const JsonRpcRequest KODI_TOGGLE_MUTE("Application.SetMute", "{\"mute\":\"toggle\"}");
+static const JsonRpcRequest KODI_CHANNEL_UP("Input.ExecuteAction", "{\"action\":\"channelup\"}");
+static const JsonRpcRequest KODI_CHANNEL_DOWN("Input.ExecuteAction", "{\"action\":\"channeldown\"}");
+static const JsonRpcRequest KODI_GET_APPLICATION_PROPERTIES("Application.GetProperties",
+                                                            "{\"properties\":[\"volume\",\"muted\"]}");
+static const JsonRpcRequest KODI_GET_TV_CHANNELS("PVR.GetChannels",
+                                                 "{\"channelgroupid\":\"alltv\","
+                                                 "\"properties\":[\"thumbnail\",\"uniqueid\",\"channelnumber\"]}");
+static const JsonRpcRequest KODI_GET_RADIO_CHANNELS("PVR.GetChannels",
+                                                    "{\"channelgroupid\":\"allradio\","
+                                                    "\"properties\":[\"thumbnail\",\"uniqueid\",\"channelnumber\"]}");
+static const JsonRpcRequest KODI_GET_PLAYLIST_ITEMS(
+    "Playlist.GetItems", "{\"properties\":[\"title\",\"album\",\"artist\",\"duration\"],\"playlistid\":0}");
+static const char KODI_PLAYER_ITEM_PROPERTIES[] =
+    "[\"title\",\"album\",\"artist\",\"season\",\"episode\",\"duration\",\"showtitle\",\"tvshowid\","
+    "\"thumbnail\",\"file\",\"fanart\",\"streamdetails\"]";
+static const char KODI_PLAYER_PROPERTIES[] = "[\"totaltime\",\"time\",\"speed\"]";
+
+// copies of everything a browse model is built from, the worker never touches the integration itself
+struct EpgGridSnapshot {
+    EpgStore      epg;
+    ChannelCache  tvChannels;
+    StringPool    strings;
+    EpgGridLayout layout;
+    QList<int>    channels;
+};
+
+struct ChannelListSnapshot {
+    ChannelCache            channels;
+    StringPool              strings;
+    QHash<QString, QString> logos;
+    QString                 type;
+};
+
+// runs on a worker thread, the finished model is moved to owner before it is handed back
+static BrowseEPGModel* buildEpgGridModel(EpgGridSnapshot snapshot, QThread* owner) {
+    // the copies read their texts from the copied pool
+    snapshot.epg.setStringPool(&snapshot.strings);
+    snapshot.tvChannels.setStringPool(&snapshot.strings);
+    const EpgStore&      epg = snapshot.epg;
+    const ChannelCache&  tvChannels = snapshot.tvChannels;
+    const EpgGridLayout& layout = snapshot.layout;
+    QStringList          commands = {};
+    BrowseEPGModel*      model = new BrowseEPGModel("", 0, 0, 0, 0, "", "", "", "", "", "", "", "", "", {}, nullptr);
+
+    for (uint hour : layout.hours()) {
+        model->addEPGItem(QString::number(hour), layout.hourX(hour), 0, 60 * EpgGridLayout::PIXELS_PER_MINUTE,
+                          EpgGridLayout::ROW_HEIGHT, "epg", "#FF0000", "#FFFFFF", layout.hourLabel(hour), "", "", "",
+                          "", "", commands);
+    }
+
+    // one row per configured channel in the configured order
+    QHash<int, int> rows;
+    for (int row = 1; row <= snapshot.channels.count(); row++) {
+        int     channel = tvChannels.byChannelNumber(snapshot.channels[row - 1]);
+        QString label = channel >= 0 ? tvChannels.label(channel) : QString();
+        rows.insert(snapshot.channels[row - 1], row);
+        model->addEPGItem(QString::number(row), 0, row, EpgGridLayout::LABEL_WIDTH, EpgGridLayout::ROW_HEIGHT, "epg",
+                          "#0000FF", "#FFFFFF", label, "", "", "", "", "", commands);
+    }
+
+    for (int epgChannel = 0; epgChannel < epg.channelCount(); epgChannel++) {
+        int channel = tvChannels.byTVHeadendUuid(epg.channelUuidHandle(epgChannel));
+        int row = channel >= 0 ? rows.value(tvChannels.at(channel).channelNumber) : 0;
+        if (row == 0) {
+            continue;
+        }
+        // the TVHeadend event id is the item id, indexes change with every eviction while the grid is shown
+        for (int i : epg.eventsBetween(epgChannel, layout.start(), layout.end())) {
+            int x = 0;
+            int width = 0;
+            if (layout.eventCell(epg.start(i), epg.stop(i), &x, &width)) {
+                model->addEPGItem(QString::number(epg.eventId(i)), x, row, width, EpgGridLayout::ROW_HEIGHT, "epg",
+                                  "#FFFF00", "#FFFFFF", epg.title(i), "", "", "", "", "", commands);
+            }
+        }
+    }
+    model->moveToThread(owner);
+    return model;
+}
+
+// runs on a worker thread, the finished model is moved to owner before it is handed back
+static BrowseChannelModel* buildChannelListModel(ChannelListSnapshot snapshot, QThread* owner) {
+    snapshot.channels.setStringPool(&snapshot.strings);
+    const ChannelCache& channels = snapshot.channels;
+    BrowseChannelModel* model = new BrowseChannelModel("", "", "", "", "", "", {}, nullptr);
+    QStringList         commands = {"PLAY"};
+    for (int channel = 0; channel < channels.count(); channel++) {
+        // cached logos are shown from disk
+        model->addchannelItem(QString::number(channels.at(channel).channelId), "", channels.label(channel), "",
+                              snapshot.type, snapshot.logos.value(channels.image(channel), channels.image(channel)),
+                              commands);
+    }
+    model->moveToThread(owner);
+    return model;
+}
 
 KodiPlugin::KodiPlugin() : Plugin("yio.plugin.kodi", USE_WORKER_THREAD) {}
 
@@ -85,6 +196,18 @@ Kodi::Kodi(const QVariantMap& config, EntitiesInterface* entities, Notifications
             for (auto& ob : map.value("epgchannels").toString().split(",")) {
                 m_epgChannelList.append(ob.toInt());
             }
+            // optional, hours of programme loaded ahead, the EPG grid loads more when it shows more
+            if (map.contains("epglookahead")) {
+                m_epgLookAheadInHours = qMax(1, map.value("epglookahead").toInt());
+            }
+            // optional, parallel requests to TVHeadend while the EPG is loaded
+            if (map.contains("tvheadendconnections")) {
+                m_tvheadendMaxConnections = qMax(1, map.value("tvheadendconnections").toInt());
+            }
+            // optional, hours finished programmes are kept in the EPG
+            if (map.contains("epgretention")) {
+                m_epgRetentionInHours = qMax(0, map.value("epgretention").toInt());
+            }
             // TODO(milo) combine host & port configuration into tvheadendclient_url?
             host = map.value("tvheadendclient_url").toString();
             port = map.value("tvheadendclient_port").toInt();
@@ -119,9 +242,21 @@ Kodi::Kodi(const QVariantMap& config, EntitiesInterface* entities, Notifications
     context_kodi = this;
     networkManagerTvHeadend = new QNetworkAccessManager(context_kodi);
     networkManagerKodi = new QNetworkAccessManager(context_kodi);
+    m_tvheadendRequestQueue = new RequestQueue(networkManagerTvHeadend, m_tvheadendMaxConnections, context_kodi);
+    m_kodiRequestQueue = new RequestQueue(networkManagerKodi, KODI_MAX_CONNECTIONS, context_kodi);
+    m_logoCache = new LogoCache(m_tvheadendRequestQueue, KODI_USERDATA_PATH "logos/", KODI_LOGO_CACHE_SIZE,
+                                KODI_LOGO_DOWNLOADS, context_kodi);
     manager = new QNetworkConfigurationManager(context_kodi);
-    m_pollingTimer = new QTimer(context_kodi);
-    m_pollingEPGLoadTimer = new QTimer(context_kodi);
+    m_pollingScheduler = new PollingScheduler(context_kodi);
+    m_pollingTaskCurrentPlayer = m_pollingScheduler->addTask([=]() { onPollingTimerTimeout(); }, KODI_POLLING_INTERVAL,
+                                                             KODI_POLLING_MAX_BACKOFF);
+    m_pollingTaskConnectionCheck = m_pollingScheduler->addTask([=]() { onPollingConnectionCheckTimeout(); },
+                                                               KODI_CONNECTIONCHECK_INTERVAL,
+                                                               KODI_CONNECTIONCHECK_INTERVAL);
+    m_pollingTaskEPGLoad = m_pollingScheduler->addTask([=]() { onPollingEPGLoadTimerTimeout(); },
+                                                       KODI_EPG_LOAD_INTERVAL, KODI_EPG_LOAD_INTERVAL);
+    // the guide of the last run is usable before TVHeadend answered
+    readEPG();
     m_progressBarTimer = new QTimer(context_kodi);
     for (QNetworkInterface& iface : QNetworkInterface::allInterfaces()) {
         if (iface.type() == QNetworkInterface::Wifi) {
@@ -187,8 +322,6 @@ void Kodi::connect() {
             context_kodi);
 
     } else {
-        QObject::connect(context_kodi, &Kodi::requestReadyKodiConnectionCheck, context_kodi,
-                         &Kodi::kodiconnectioncheck);
         QObject::connect(context_kodi, &Kodi::requestReadyTvheadendConnectionCheck, context_kodi,
                          &Kodi::Tvheadendconnectioncheck);
 
@@ -205,10 +338,7 @@ void Kodi::connect() {
         }
         if (!m_kodiJSONRPCUrl.isEmpty()) {
             m_flagKodiConfigured = true;
-            postRequest(
-                "{ \"jsonrpc\": \"2.0\","
-                " \"method\": \"JSONRPC.Ping\", \"params\": {  },"
-                " \"id\":\"ConnectionCheck\"}");
+            postRequest(KODI_PING, [=](const QJsonDocument& doc) { kodiconnectioncheck(doc); });
         } else {
             if (_networktries == MAX_CONNECTIONTRY) {
                 _networktries = 0;
@@ -224,10 +354,7 @@ void Kodi::connect() {
                 qCWarning(m_logCategory) << "Kodi not configured";
             } else {
                 _networktries++;
-                postRequest(
-                    "{ \"jsonrpc\": \"2.0\","
-                    " \"method\": \"JSONRPC.Ping\", \"params\": {  },"
-                    " \"id\":\"ConnectionCheck\"}");
+                postRequest(KODI_PING, [=](const QJsonDocument& doc) { kodiconnectioncheck(doc); });
             }
         }
     }
@@ -255,77 +382,142 @@ void Kodi::clientDisconnected() {
         QObject::disconnect(m_tcpSocketKodiEventServer, &QTcpSocket::readyRead, context_kodi, &Kodi::readTcpData);
         QObject::disconnect(m_tcpSocketKodiEventServer, &QTcpSocket::disconnected, context_kodi,
                             &Kodi::clientDisconnected);
+        updatePollingInterval();
+        m_eventServerFramer.clear();
+        // requests sent over the socket will never be answered
+        QList<int> ids;
+        for (auto it = m_kodiPendingRequests.constBegin(); it != m_kodiPendingRequests.constEnd(); ++it) {
+            if (it->eventServer) {
+                ids.append(it.key());
+            }
+        }
+        for (int id : ids) {
+            completeKodiRequest(id, QJsonDocument());
+        }
     }
 }
 
 void Kodi::readTcpData() {
-    QString         reply = m_tcpSocketKodiEventServer->readAll();
-    QJsonParseError parseerror;
-    QJsonDocument   doc = QJsonDocument::fromJson(reply.toUtf8(), &parseerror);
-    if (parseerror.error != QJsonParseError::NoError) {
-        qCWarning(m_logCategory) << "JSON error : " << parseerror.errorString();
-        return;
-    }
-    if (!doc.isEmpty()) {
-        QVariantMap replyMap = doc.toVariant().toMap();
-        if (replyMap.value("jsonrpc") == "2.0" && replyMap.contains("method")) {
-            if (replyMap.value("method") == "System.OnQuit") {
-                m_flagKodiOnline = false;
-                m_flagTVHeadendOnline = false;
-                disconnect();
-            } else if (replyMap.value("method") == "Player.OnResume") {
-                // m_flag = false;
-                m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::GetActivePlayers;
-                EntityInterface* entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
-                entity->updateAttrByIndex(MediaPlayerDef::STATE, MediaPlayerDef::States::PLAYING);
-                getCurrentPlayer();
-            } else if (replyMap.value("method") == "Player.OnPlay") {
+    // one read may contain several messages or only a part of one
+    m_eventServerFramer.append(m_tcpSocketKodiEventServer->readAll());
+    for (QByteArray message = m_eventServerFramer.next(); !message.isNull(); message = m_eventServerFramer.next()) {
+        QJsonParseError parseerror;
+        QJsonDocument   doc = QJsonDocument::fromJson(message, &parseerror);
+        if (parseerror.error != QJsonParseError::NoError) {
+            qCWarning(m_logCategory) << "JSON error : " << parseerror.errorString();
+            continue;
+        }
+        if (doc.isArray() || (doc.object().contains("id") && !doc.object().contains("method"))) {
+            // reply (or batch reply) to a request which was sent over the event server socket
+            dispatchKodiReply(doc);
+        } else if (!doc.isEmpty()) {
+            if (doc.object().value("jsonrpc") == "2.0" && doc.object().contains("method")) {
+                handleKodiNotification(doc.object().value("method").toString(),
+                                       doc.object().value("params").toObject().value("data").toObject());
             }
         }
     }
 }
 
-void Kodi::disconnect() {
-    if (m_kodireply != nullptr) {
-        if (!m_kodireply->isFinished()) {
-            m_kodireply->abort();
-            // m_kodireply->deleteLater();
-            // m_kodireply = nullptr;
-        }
-    }
+void Kodi::handleKodiNotification(const QString& method, const QJsonObject& data) {
+    EntityInterface* entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
+    QJsonObject      player = data.value("player").toObject();
+    QJsonObject      item = data.value("item").toObject();
 
-    if (m_tvreply != nullptr) {
-        if (!m_tvreply->isFinished()) {
-            m_tvreply->abort();
-            // m_tvreply->deleteLater();
-            // m_tvreply = nullptr;
+    if (method == "System.OnQuit") {
+        m_flagKodiOnline = false;
+        m_flagTVHeadendOnline = false;
+        disconnect();
+    } else if (!entity) {
+        return;
+    } else if (method == "Player.OnPlay" || method == "Player.OnResume" || method == "Player.OnAVChange") {
+        if (player.contains("playerid")) {
+            m_currentkodiplayerid = player.value("playerid").toInt();
         }
+        if (method == "Player.OnPlay") {
+            // show what the notification already knows, artwork and times follow with the refresh below
+            if (item.contains("type")) {
+                entity->updateAttrByIndex(MediaPlayerDef::MEDIATYPE, item.value("type").toString());
+            }
+            if (item.contains("title")) {
+                entity->updateAttrByIndex(MediaPlayerDef::MEDIATITLE, item.value("title").toString());
+            }
+            // the title is already set, make sure the refresh does not skip the new item
+            m_firstrun = true;
+        }
+        if (!player.contains("speed") || player.value("speed").toInt() != 0) {
+            m_progressBarTimer->stop();
+            m_progressBarTimer->start();
+            entity->updateAttrByIndex(MediaPlayerDef::STATE, MediaPlayerDef::States::PLAYING);
+        }
+        m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::GetActivePlayers;
+        getCurrentPlayer();
+    } else if (method == "Player.OnPause") {
+        m_progressBarTimer->stop();
+        entity->updateAttrByIndex(MediaPlayerDef::STATE, MediaPlayerDef::States::IDLE);
+    } else if (method == "Player.OnSpeedChanged") {
+        if (player.value("speed").toInt() > 0) {
+            m_progressBarTimer->stop();
+            m_progressBarTimer->start();
+            entity->updateAttrByIndex(MediaPlayerDef::STATE, MediaPlayerDef::States::PLAYING);
+        } else {
+            m_progressBarTimer->stop();
+            entity->updateAttrByIndex(MediaPlayerDef::STATE, MediaPlayerDef::States::IDLE);
+        }
+    } else if (method == "Player.OnSeek") {
+        if (player.contains("time")) {
+            QJsonObject time = player.value("time").toObject();
+            int         hours = time.value("hours").toInt();
+            int         milliseconds = time.value("milliseconds").toInt();
+            int         minutes = time.value("minutes").toInt();
+            int         seconds = time.value("seconds").toInt();
+            int         totalmilliseconds = (hours * 3600000) + (minutes * 60000) + (seconds * 1000) + milliseconds;
+            m_progressBarPosition = totalmilliseconds / 1000;
+            entity->updateAttrByIndex(MediaPlayerDef::MEDIAPROGRESS, m_progressBarPosition);
+        }
+    } else if (method == "Player.OnStop") {
+        m_progressBarTimer->stop();
+        m_currentkodiplayertype = "unknown";
+        m_currentkodiplayerid = -1;
+        m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::Stopped;
+        clearMediaPlayerEntity();
+    } else if (method == "Application.OnVolumeChanged") {
+        entity->updateAttrByIndex(MediaPlayerDef::VOLUME, qRound(data.value("volume").toDouble()));
     }
+}
 
-    if (m_pollingTimer->isActive()) {
-        m_pollingTimer->stop();
-        QObject::disconnect(m_pollingTimer, &QTimer::timeout, context_kodi, &Kodi::onPollingTimerTimeout);
-    }
+void Kodi::disconnect() {
+    m_kodiRequestQueue->abortAll();
+    m_tvheadendRequestQueue->abortAll();
+    m_logoCache->cancel();
+    // aborted EPG requests never answer, an unfinished cycle has not set the expiry yet and is started anew
+    m_epgGeneration++;
+    m_epgRequestsPending = 0;
+    m_epgChannelsToLoad.clear();
+    // an unfinished extension has not moved the window and is requested again when the grid is opened
+    m_epgExtensionGeneration++;
+    m_epgExtensionsPending = 0;
+
+    m_pollingScheduler->stopAll();
     if (m_progressBarTimer->isActive()) {
         m_progressBarTimer->stop();
         QObject::disconnect(m_progressBarTimer, &QTimer::timeout, context_kodi, &Kodi::onProgressBarTimerTimeout);
     }
-    if (m_pollingEPGLoadTimer->isActive()) {
-        m_pollingEPGLoadTimer->stop();
-        QObject::disconnect(m_pollingEPGLoadTimer, &QTimer::timeout, context_kodi, &Kodi::onPollingEPGLoadTimerTimeout);
-    }
 
     if (m_flagKodiEventServerOnline) {
+        m_flagKodiEventServerOnline = false;
+        m_eventServerFramer.clear();
         m_tcpSocketKodiEventServer->close();
         QObject::disconnect(m_tcpSocketKodiEventServer, &QTcpSocket::readyRead, context_kodi, &Kodi::readTcpData);
         QObject::disconnect(m_tcpSocketKodiEventServer, &QTcpSocket::disconnected, context_kodi,
                             &Kodi::clientDisconnected);
     }
 
-    QObject::disconnect(context_kodi, &Kodi::requestReadyKodiConnectionCheck, context_kodi, &Kodi::kodiconnectioncheck);
     QObject::disconnect(context_kodi, &Kodi::requestReadyTvheadendConnectionCheck, context_kodi,
                         &Kodi::Tvheadendconnectioncheck);
-    QObject::disconnect(context_kodi, &Kodi::requestReadygetCurrentPlayer, context_kodi, &Kodi::updateCurrentPlayer);
+    // replies which are still on their way are ignored after a reconnect
+    m_kodiPendingRequests.clear();
+    m_kodiCoalescedRequests.clear();
     clearMediaPlayerEntity();
     // m_flagKodiOnline = false;
     /*m_notifications->add(
@@ -400,63 +592,122 @@ void Kodi::leaveStandby() {
     }*/
 }
 
-void Kodi::getTVEPGfromTVHeadend(int KodiChannelNumber) {
-    QObject* context_getTVEPGfromTVHeadend = new QObject(context_kodi);
-    QObject::connect(context_kodi, &Kodi::requestReadygetTVEPGfromTVHeadend, context_getTVEPGfromTVHeadend,
-                     [=](const QJsonDocument& resultJSONDocument) {
-                         // createa a map object
-                         m_currentEPG.append(resultJSONDocument.object().value("entries").toVariant().toList());
-                         context_getTVEPGfromTVHeadend->deleteLater();
-                     });
+bool Kodi::getTVEPGfromTVHeadend(int KodiChannelNumber, uint from, uint to, const EpgReplyHandler& handler) {
     if (m_flagTVHeadendOnline && m_mapKodiChannelNumberToTVHeadendUUID.count() > 0) {
-        tvheadendGetRequest(
-            "/api/epg/events/grid",
-            {{"limit", "1000"}, {"channel", m_mapKodiChannelNumberToTVHeadendUUID.value(KodiChannelNumber)}});
+        // only the events overlapping [from, to), the limit is a safety net for very dense channels
+        QString filter = QString("[{\"field\":\"stop\",\"type\":\"numeric\",\"value\":%1,\"comparison\":\"gt\"},"
+                                 "{\"field\":\"start\",\"type\":\"numeric\",\"value\":%2,\"comparison\":\"lt\"}]")
+                             .arg(from)
+                             .arg(to);
+        QNetworkRequest request =
+            tvheadendRequest("/api/epg/events/grid",
+                             {{"limit", "1000"},
+                              {"channel", m_mapKodiChannelNumberToTVHeadendUUID.value(KodiChannelNumber)},
+                              {"filter", filter}});
+        QString u = request.url().toString();
+        m_tvheadendRequestQueue->get(request, RequestQueue::Background, [=](QNetworkReply* reply) {
+            bool valid = false;
+            int  events = 0;
+            if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 0) {
+                if (reply->error()) {
+                    qCWarning(m_logCategory) << reply->errorString();
+                }
+                // only the shown fields are taken from the bytes, no QJsonDocument is built for the whole grid
+                valid = !reply->error() && m_epgGridReader.read(reply->readAll(), [&](const EpgEvent& event) {
+                    m_currentEPG.add(event);
+                    events++;
+                });
+                if (!valid) {
+                    qCWarning(m_logCategory) << "EPG reply of" << u << "is not valid";
+                }
+            } else {
+                emit requestReadyTvheadendConnectionCheck(QJsonDocument());
+            }
+            handler(valid, events);
+        });
+        return true;
     }
+    return false;
 }
-void Kodi::getSingleTVChannelList(QString param) {
-    QObject* context_getSingleTVChannelList = new QObject(context_kodi);
 
-    QString channelnumber = "0";
-    for (int i = 0; i < m_KodiTVChannelList.length(); i++) {
-        if (m_KodiTVChannelList[i].toMap().value("channelid").toString() == param) {
-            channelnumber = m_KodiTVChannelList[i].toMap().value("channelnumber").toString();
+void Kodi::extendEPGWindow(uint until) {
+    // nothing is loaded before the first load cycle, a running extension is waited for
+    if (m_epgLoadedUntil == 0 || until <= m_epgLoadedUntil || m_epgExtensionsPending > 0) {
+        return;
+    }
+    uint from = m_epgLoadedUntil;
+    int  generation = ++m_epgExtensionGeneration;
+    m_epgExtensionFailed = false;
+    for (int channel : m_epgChannelList) {
+        bool requested = getTVEPGfromTVHeadend(channel, from, until, [=](bool valid, int) {
+            if (generation != m_epgExtensionGeneration) {
+                return;
+            }
+            m_epgExtensionFailed |= !valid;
+            if (--m_epgExtensionsPending > 0) {
+                return;
+            }
+            // the window only moves on if every channel answered, otherwise the range is requested again next time
+            if (!m_epgExtensionFailed) {
+                m_epgLoadedUntil = qMax(m_epgLoadedUntil, until);
+            }
+            writeEPG();
+            // the grid still shown gets the new events
+            if (m_epgGridGeneration == m_browseGeneration) {
+                showEpgGrid();
+            }
+        });
+        if (requested) {
+            m_epgExtensionsPending++;
         }
     }
+}
+void Kodi::getSingleTVChannelList(QString param) {
+    QString channelnumber = "0";
+    int     channel = m_KodiTVChannels.byChannelId(param.toInt());
+    if (channel >= 0) {
+        channelnumber = QString::number(m_KodiTVChannels.at(channel).channelNumber);
+    }
+    // the model is installed once Kodi answered, unless the user browsed elsewhere meanwhile
+    int generation = ++m_browseGeneration;
     if (channelnumber != "0" && m_flagTVHeadendOnline && m_currentEPG.count() > 0) {
-        QObject::connect(
-            context_kodi, &Kodi::requestReadygetSingleTVChannelList, context_getSingleTVChannelList,
+        postRequest(
+            KODI_PING,
             [=](const QJsonDocument& resultJSONDocument) {
+                if (generation != m_browseGeneration) {
+                    return;
+                }
                 EntityInterface* entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
 
+                // the channel list may have been reloaded while the request was pending
+                int channel = m_KodiTVChannels.byChannelId(param.toInt());
+                if (channel < 0) {
+                    return;
+                }
+
+                // the EPG is keyed by the TVHeadend UUID, TVHeadend may number its channels differently than Kodi
                 QMap<QString, QString> currenttvprogramm;
-                for (int i = 0; i < m_currentEPG.length(); i++) {
-                    if (m_currentEPG[i].toMap().value("channelNumber") == channelnumber) {
-                        currenttvprogramm.insert(m_currentEPG[i].toMap().value("start").toString(),
-                                                 m_currentEPG[i].toMap().value("title").toString());
+                int                    epgChannel = m_currentEPG.channelByUuid(m_KodiTVChannels.tvheadendUuid(channel));
+                if (epgChannel >= 0) {
+                    // the running programme followed by the next ones
+                    uint         now = QDateTime::currentDateTime().toTime_t();
+                    int          running = m_currentEPG.eventAt(epgChannel, now);
+                    QVector<int> events = m_currentEPG.nextEvents(epgChannel, now, KODI_EPG_CHANNEL_EVENTS);
+                    if (running >= 0) {
+                        events.prepend(running);
+                    }
+                    for (int event : events) {
+                        currenttvprogramm.insert(QString::number(m_currentEPG.start(event)),
+                                                 m_currentEPG.title(event));
                     }
                 }
                 if (currenttvprogramm.count() > 0) {
-                    int currenttvchannelarrayid = 0;
-                    for (int i = 0; i < m_KodiTVChannelList.length(); i++) {
-                        if (m_KodiTVChannelList[i].toMap().value("channelid") == param) {
-                            currenttvchannelarrayid = i;
-                            break;
-                        }
-                    }
-                    QString     id = m_KodiTVChannelList[currenttvchannelarrayid].toMap().value("channelid").toString();
-                    QString     title = m_KodiTVChannelList[currenttvchannelarrayid].toMap().value("label").toString();
+                    QString     id = QString::number(m_KodiTVChannels.at(channel).channelId);
+                    QString     title = m_KodiTVChannels.label(channel);
                     QString     subtitle = "";
                     QString     type = "tvchannellist";
                     QString     time = "";
-                    QString     image = fixUrl(QString::fromStdString(QByteArray::fromPercentEncoding(
-                                                                      m_KodiTVChannelList[currenttvchannelarrayid]
-                                                                          .toMap()
-                                                                          .value("thumbnail")
-                                                                          .toString()
-                                                                          .toUtf8())
-                                                                      .toStdString())
-                                               .mid(8));
+                    QString     image = m_logoCache->url(m_KodiTVChannels.image(channel));
                     QStringList commands = {"PLAY"};
                     /*BrowseTvChannelModel* tvchannel = nullptr;
                     if (entity) {
@@ -471,9 +722,8 @@ void Kodi::getSingleTVChannelList(QString param) {
                         QDateTime timestamp;
                         timestamp.setTime_t(key.toUInt());
 
-                        tvchannel->addchannelItem(
-                            m_KodiTVChannelList[currenttvchannelarrayid].toMap().value("channelid").toString(),
-                            timestamp.toString("hh:mm"), currenttvprogramm.value(key), "", "tvchannel", "", commands);
+                        tvchannel->addchannelItem(id, timestamp.toString("hh:mm"), currenttvprogramm.value(key), "",
+                                                  "tvchannel", "", commands);
                     }
 
                     if (entity) {
@@ -487,33 +737,16 @@ void Kodi::getSingleTVChannelList(QString param) {
                 } else {
                     // EntityInterface* entity =
                     // static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
-                    int currenttvchannelarrayid = 0;
-                    for (int i = 0; i < m_KodiTVChannelList.length(); i++) {
-                        if (m_KodiTVChannelList[i].toMap().value("channelid") == param) {
-                            // currenttvchannel = m_KodiTVChannelList[i].toMap();
-                            currenttvchannelarrayid = i;
-                            break;
-                        }
-                    }
-                    QString     id = m_KodiTVChannelList[currenttvchannelarrayid].toMap().value("channelid").toString();
-                    QString     title = m_KodiTVChannelList[currenttvchannelarrayid].toMap().value("label").toString();
+                    QString     id = QString::number(m_KodiTVChannels.at(channel).channelId);
+                    QString     title = m_KodiTVChannels.label(channel);
                     QString     subtitle = "";
                     QString     type = "tvchannellist";
-                    QString     image = fixUrl(QString::fromStdString(QByteArray::fromPercentEncoding(
-                                                                      m_KodiTVChannelList[currenttvchannelarrayid]
-                                                                          .toMap()
-                                                                          .value("thumbnail")
-                                                                          .toString()
-                                                                          .toUtf8())
-                                                                      .toStdString())
-                                               .mid(8));
+                    QString     image = m_logoCache->url(m_KodiTVChannels.image(channel));
                     QStringList commands = {"PLAY"};
 
                     BrowseChannelModel* tvchannel =
                         new BrowseChannelModel(id, "", title, subtitle, type, image, commands, nullptr);
-                    tvchannel->addchannelItem(
-                        m_KodiTVChannelList[currenttvchannelarrayid].toMap().value("channelid").toString(), " ",
-                        "No programm available", "", "tvchannel", "", commands);
+                    tvchannel->addchannelItem(id, " ", "No programm available", "", "tvchannel", "", commands);
                     if (entity) {
                         MediaPlayerInterface* me = static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
                         me->setBrowseModel(tvchannel);
@@ -521,13 +754,7 @@ void Kodi::getSingleTVChannelList(QString param) {
                 }
 
                 // }
-
-                context_getSingleTVChannelList->deleteLater();
             });
-
-        postRequest(
-            "{ \"jsonrpc\": \"2.0\", \"method\": \"JSONRPC.Ping\","
-            " \"params\": {  }, \"id\": \"getSingleTVChannelList\" }");
         /*else if (!m_flagTVHeadendOnline) {
            QObject::connect(
                this, &Kodi::requestReadygetSingleTVChannelList, context_getSingleTVChannelList,
@@ -583,40 +810,31 @@ void Kodi::getSingleTVChannelList(QString param) {
                " \"params\": {  }, \"id\": \"getSingleTVChannelList\" }");
        } */
     } else {
-        QObject::connect(
-            context_kodi, &Kodi::requestReadygetSingleTVChannelList, context_getSingleTVChannelList,
+        qCDebug(m_logCategory) << "GET USERS PLAYLIST";
+        postRequest(
+            KODI_PING,
             [=](const QJsonDocument& resultJSONDocument) {
+                if (generation != m_browseGeneration) {
+                    return;
+                }
                 if (resultJSONDocument.object().contains("result")) {
                     if (resultJSONDocument.object().value("result") == "pong") {
                         EntityInterface* entity =
                             static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
-                        int currenttvchannelarrayid = 0;
-                        for (int i = 0; i < m_KodiTVChannelList.length(); i++) {
-                            if (m_KodiTVChannelList[i].toMap().value("channelid") == param) {
-                                // currenttvchannel = m_KodiTVChannelList[i].toMap();
-                                currenttvchannelarrayid = i;
-                                break;
-                            }
+                        int channel = m_KodiTVChannels.byChannelId(param.toInt());
+                        if (channel < 0) {
+                            return;
                         }
-                        QString id = m_KodiTVChannelList[currenttvchannelarrayid].toMap().value("channelid").toString();
-                        QString title = m_KodiTVChannelList[currenttvchannelarrayid].toMap().value("label").toString();
-                        QString subtitle = "";
-                        QString type = "tvchannellist";
-                        QString image = fixUrl(QString::fromStdString(QByteArray::fromPercentEncoding(
-                                                                          m_KodiTVChannelList[currenttvchannelarrayid]
-                                                                              .toMap()
-                                                                              .value("thumbnail")
-                                                                              .toString()
-                                                                              .toUtf8())
-                                                                          .toStdString())
-                                                   .mid(8));
+                        QString     id = QString::number(m_KodiTVChannels.at(channel).channelId);
+                        QString     title = m_KodiTVChannels.label(channel);
+                        QString     subtitle = "";
+                        QString     type = "tvchannellist";
+                        QString     image = m_logoCache->url(m_KodiTVChannels.image(channel));
                         QStringList commands = {};
 
                         BrowseChannelModel* tvchannel =
                             new BrowseChannelModel(id, "", title, subtitle, type, image, commands, nullptr);
-                        tvchannel->addchannelItem(
-                            m_KodiTVChannelList[currenttvchannelarrayid].toMap().value("channelid").toString(), "",
-                            "No programm available", "", "tvchannel", "", commands);
+                        tvchannel->addchannelItem(id, "", "No programm available", "", "tvchannel", "", commands);
                         if (entity) {
                             MediaPlayerInterface* me =
                                 static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
@@ -626,16 +844,7 @@ void Kodi::getSingleTVChannelList(QString param) {
 
                     // }
                 }
-                context_getSingleTVChannelList->deleteLater();
-                // QObject::disconnect(this, &Kodi::requestReadygetSingleTVChannelList,
-                // context_getSingleTVChannelList, 0);
             });
-        qCDebug(m_logCategory) << "GET USERS PLAYLIST";
-        QString jsonstring;
-
-        postRequest(
-            "{ \"jsonrpc\": \"2.0\", \"method\": \"JSONRPC.Ping\", \"params\": {  }, \"id\": "
-            "\"getSingleTVChannelList\" }");
     }
 }
 void Kodi::getKodiChannelNumberToTVHeadendUUIDMapping() {
@@ -644,31 +853,26 @@ void Kodi::getKodiChannelNumberToTVHeadendUUIDMapping() {
     QObject::connect(
         context_kodi, &Kodi::requestReadygetKodiChannelNumberToTVHeadendUUIDMapping,
         context_getKodiChannelNumberToTVHeadendUUIDMapping, [=](const QJsonDocument& repliedJsonDocument) {
-            if (m_KodiTVChannelList.length() > 0 && m_mapKodiChannelNumberToTVHeadendUUID.isEmpty() &&
+            if (m_KodiTVChannels.count() > 0 && m_mapKodiChannelNumberToTVHeadendUUID.isEmpty() &&
                 m_mapTVHeadendUUIDToKodiChannelNumber.isEmpty()) {
-                if (!read(&m_mapKodiChannelNumberToTVHeadendUUID) || !read(&m_mapTVHeadendUUIDToKodiChannelNumber)) {
-                    QMap<QString, QString> inv_map;
-                    auto                   entries = repliedJsonDocument["entries"];
-                    for (auto item : entries.toArray()) {
-                        auto obj = item.toObject();
-                        inv_map[obj["val"].toString()] = obj["key"].toString();
-                    }
+                QMap<QString, QString> inv_map;
+                auto                   entries = repliedJsonDocument["entries"];
+                for (auto item : entries.toArray()) {
+                    auto obj = item.toObject();
+                    inv_map[obj["val"].toString()] = obj["key"].toString();
+                }
 
-                    for (int j = 0; j < m_KodiTVChannelList.length(); j++) {
-                        auto it = inv_map.find(m_KodiTVChannelList[j].toMap().values("label")[0].toString());
-                        if (it != inv_map.end() &&
-                            !m_mapKodiChannelNumberToTVHeadendUUID.contains(
-                                m_KodiTVChannelList[j].toMap().value("channelnumber").toInt()) &&
-                            !m_mapTVHeadendUUIDToKodiChannelNumber.contains(it.value())) {
-                            m_mapKodiChannelNumberToTVHeadendUUID.insert(
-                                m_KodiTVChannelList[j].toMap().value("channelnumber").toInt(), it.value());
-                            m_mapTVHeadendUUIDToKodiChannelNumber.insert(
-                                it.value(), m_KodiTVChannelList[j].toMap().value("channelnumber").toInt());
-                        }
+                for (int j = 0; j < m_KodiTVChannels.count(); j++) {
+                    int  number = m_KodiTVChannels.at(j).channelNumber;
+                    auto it = inv_map.find(m_KodiTVChannels.label(j));
+                    if (it != inv_map.end() && !m_mapKodiChannelNumberToTVHeadendUUID.contains(number) &&
+                        !m_mapTVHeadendUUIDToKodiChannelNumber.contains(it.value())) {
+                        m_mapKodiChannelNumberToTVHeadendUUID.insert(number, it.value());
+                        m_mapTVHeadendUUIDToKodiChannelNumber.insert(it.value(), number);
                     }
-                    write(m_mapKodiChannelNumberToTVHeadendUUID);
-                    write(m_mapTVHeadendUUIDToKodiChannelNumber);
                 }
+                writeChannelMapping("tv", m_KodiTVChannels, m_mapKodiChannelNumberToTVHeadendUUID);
+                applyTVHeadendUUIDs();
             }
 
             context_getKodiChannelNumberToTVHeadendUUIDMapping->deleteLater();
@@ -682,32 +886,26 @@ void Kodi::getKodiChannelNumberToRadioHeadendUUIDMapping() {
     QObject::connect(
         context_kodi, &Kodi::requestReadygetKodiChannelNumberToRadioHeadendUUIDMapping,
         context_getKodiChannelNumberToRadioHeadendUUIDMapping, [=](const QJsonDocument& repliedJsonDocument) {
-            if (m_KodiRadioChannelList.length() > 0 && m_mapKodiChannelNumberToRadioHeadendUUID.isEmpty() &&
+            if (m_KodiRadioChannels.count() > 0 && m_mapKodiChannelNumberToRadioHeadendUUID.isEmpty() &&
                 m_mapRadioHeadendUUIDToKodiChannelNumber.isEmpty()) {
-                if (!read(&m_mapKodiChannelNumberToRadioHeadendUUID) ||
-                    !read(&m_mapRadioHeadendUUIDToKodiChannelNumber)) {
-                    QMap<QString, QString> inv_map;
-                    auto                   entries = repliedJsonDocument["entries"];
-                    for (auto item : entries.toArray()) {
-                        auto obj = item.toObject();
-                        inv_map[obj["val"].toString()] = obj["key"].toString();
-                    }
+                QMap<QString, QString> inv_map;
+                auto                   entries = repliedJsonDocument["entries"];
+                for (auto item : entries.toArray()) {
+                    auto obj = item.toObject();
+                    inv_map[obj["val"].toString()] = obj["key"].toString();
+                }
 
-                    for (int j = 0; j < m_KodiRadioChannelList.length(); j++) {
-                        auto it = inv_map.find(m_KodiRadioChannelList[j].toMap().values("label")[0].toString());
-                        if (it != inv_map.end() &&
-                            !m_mapKodiChannelNumberToRadioHeadendUUID.contains(
-                                m_KodiRadioChannelList[j].toMap().value("channelnumber").toInt()) &&
-                            !m_mapRadioHeadendUUIDToKodiChannelNumber.contains(it.value())) {
-                            m_mapKodiChannelNumberToRadioHeadendUUID.insert(
-                                m_KodiRadioChannelList[j].toMap().value("channelnumber").toInt(), it.value());
-                            m_mapRadioHeadendUUIDToKodiChannelNumber.insert(
-                                it.value(), m_KodiRadioChannelList[j].toMap().value("channelnumber").toInt());
-                        }
+                for (int j = 0; j < m_KodiRadioChannels.count(); j++) {
+                    int  number = m_KodiRadioChannels.at(j).channelNumber;
+                    auto it = inv_map.find(m_KodiRadioChannels.label(j));
+                    if (it != inv_map.end() && !m_mapKodiChannelNumberToRadioHeadendUUID.contains(number) &&
+                        !m_mapRadioHeadendUUIDToKodiChannelNumber.contains(it.value())) {
+                        m_mapKodiChannelNumberToRadioHeadendUUID.insert(number, it.value());
+                        m_mapRadioHeadendUUIDToKodiChannelNumber.insert(it.value(), number);
                     }
-                    write(m_mapKodiChannelNumberToRadioHeadendUUID);
-                    write(m_mapRadioHeadendUUIDToKodiChannelNumber);
                 }
+                writeChannelMapping("radio", m_KodiRadioChannels, m_mapKodiChannelNumberToRadioHeadendUUID);
+                applyTVHeadendUUIDs();
             }
             context_getKodiChannelNumberToRadioHeadendUUIDMapping->deleteLater();
         });
@@ -715,64 +913,60 @@ void Kodi::getKodiChannelNumberToRadioHeadendUUIDMapping() {
 }
 
 void Kodi::getKodiAvailableRadioChannelList() {
-    QObject* context_getgetKodiAvailableRadioChannelList = new QObject(context_kodi);
-
-    QObject::connect(context_kodi, &Kodi::requestReadygetKodiAvailableRadioChannelList,
-                     context_getgetKodiAvailableRadioChannelList, [=](const QJsonDocument& resultJSONDocument) {
-                         if (resultJSONDocument.object().contains("result")) {
-                             QString strJson(resultJSONDocument.toJson(QJsonDocument::Compact));
-                             // qCDebug(m_logCategory) << strJson;
-                             m_KodiRadioChannelList =
-                                 resultJSONDocument.object().value("result")["channels"].toVariant().toList();
-                             if (m_flagTVHeadendOnline) {
-                                 if (m_mapKodiChannelNumberToRadioHeadendUUID.isEmpty()) {
-                                     getKodiChannelNumberToRadioHeadendUUIDMapping();
-                                 } else {
-                                     qCDebug(m_logCategory) << "m_mapKodiChannelNumberToTVHeadendUUID already loaded";
-                                 }
-                             } else {
-                                 qCDebug(m_logCategory) << "TV Headend not configured";
-                             }
-                         }
-                         context_getgetKodiAvailableRadioChannelList->deleteLater();
-                     });
+    KodiReplyHandler handler = [=](const QJsonDocument& resultJSONDocument) {
+        if (resultJSONDocument.object().contains("result")) {
+            m_KodiRadioChannels.load(resultJSONDocument.object().value("result")["channels"].toArray(),
+                                     m_tvheadendJSONUrl.host());
+            // a mapping stored for this lineup saves the TVHeadend channel list download and the matching
+            if (!readChannelMapping("radio", m_KodiRadioChannels, &m_mapKodiChannelNumberToRadioHeadendUUID,
+                                    &m_mapRadioHeadendUUIDToKodiChannelNumber)) {
+                m_mapKodiChannelNumberToRadioHeadendUUID.clear();
+                m_mapRadioHeadendUUIDToKodiChannelNumber.clear();
+            }
+            applyTVHeadendUUIDs();
+            getTVChannelLogos();
+            if (m_flagTVHeadendOnline) {
+                if (m_mapKodiChannelNumberToRadioHeadendUUID.isEmpty()) {
+                    getKodiChannelNumberToRadioHeadendUUIDMapping();
+                } else {
+                    qCDebug(m_logCategory) << "m_mapKodiChannelNumberToTVHeadendUUID already loaded";
+                }
+            } else {
+                qCDebug(m_logCategory) << "TV Headend not configured";
+            }
+        }
+    };
     if (m_flagKodiOnline) {
-        QString jsonstring =
-            "{\"jsonrpc\":\"2.0\",\"id\": \"getKodiAvailableRadioChannelList\",\"method\":\"PVR.GetChannels\","
-            " \"params\": {\"channelgroupid\": \"allradio\", \"properties\":"
-            "[\"thumbnail\",\"uniqueid\",\"channelnumber\"]}}";
-        postRequest(jsonstring);
+        postRequest(KODI_GET_RADIO_CHANNELS, handler);
     }
 }
 
 void Kodi::getKodiAvailableTVChannelList() {
-    QObject* context_getgetKodiAvailableTVChannelList = new QObject(context_kodi);
-
-    QObject::connect(context_kodi, &Kodi::requestReadygetKodiAvailableTVChannelList,
-                     context_getgetKodiAvailableTVChannelList, [=](const QJsonDocument& resultJSONDocument) {
-                         if (resultJSONDocument.object().contains("result")) {
-                             QString strJson(resultJSONDocument.toJson(QJsonDocument::Compact));
-                             // qCDebug(m_logCategory) << strJson;
-                             m_KodiTVChannelList =
-                                 resultJSONDocument.object().value("result")["channels"].toVariant().toList();
-                             if (m_flagTVHeadendOnline) {
-                                 if (m_mapKodiChannelNumberToTVHeadendUUID.isEmpty()) {
-                                     getKodiChannelNumberToTVHeadendUUIDMapping();
-                                 } else {
-                                     qCDebug(m_logCategory) << "m_mapKodiChannelNumberToTVHeadendUUID already loaded";
-                                 }
-                             } else {
-                                 qCDebug(m_logCategory) << "TV Headend not configured";
-                             }
-                         }
-                         context_getgetKodiAvailableTVChannelList->deleteLater();
-                     });
+    KodiReplyHandler handler = [=](const QJsonDocument& resultJSONDocument) {
+        if (resultJSONDocument.object().contains("result")) {
+            m_KodiTVChannels.load(resultJSONDocument.object().value("result")["channels"].toArray(),
+                                  m_tvheadendJSONUrl.host());
+            // a mapping stored for this lineup saves the TVHeadend channel list download and the matching
+            if (!readChannelMapping("tv", m_KodiTVChannels, &m_mapKodiChannelNumberToTVHeadendUUID,
+                                    &m_mapTVHeadendUUIDToKodiChannelNumber)) {
+                m_mapKodiChannelNumberToTVHeadendUUID.clear();
+                m_mapTVHeadendUUIDToKodiChannelNumber.clear();
+            }
+            applyTVHeadendUUIDs();
+            getTVChannelLogos();
+            if (m_flagTVHeadendOnline) {
+                if (m_mapKodiChannelNumberToTVHeadendUUID.isEmpty()) {
+                    getKodiChannelNumberToTVHeadendUUIDMapping();
+                } else {
+                    qCDebug(m_logCategory) << "m_mapKodiChannelNumberToTVHeadendUUID already loaded";
+                }
+            } else {
+                qCDebug(m_logCategory) << "TV Headend not configured";
+            }
+        }
+    };
     if (m_flagKodiOnline) {
-        QString jsonstring =
-            "{\"jsonrpc\":\"2.0\",\"id\": \"getKodiAvailableTVChannelList\",\"method\":\"PVR.GetChannels\","
-            " \"params\": {\"channelgroupid\": \"alltv\", \"properties\":"
-            "[\"thumbnail\",\"uniqueid\",\"channelnumber\"]}}";
-        postRequest(jsonstring);
+        postRequest(KODI_GET_TV_CHANNELS, handler);
     }
 }
 
@@ -786,67 +980,57 @@ void Kodi::getCompleteTVChannelList(QString param) {
 
             if (resultJSONDocument.object().contains("result")) {
                 if (resultJSONDocument.object().value("result").toString() == "pong") {*/
-    EntityInterface* entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
-
-    if (param == "Radio") {
-        QString     channelId = "";
-        QString     label = "";
-        QString     thumbnail = "";
-        QString     unqueId = "";
-        QString     type = "tvchannellist";
-        QStringList commands = {};
-
-        /*BrowseChannelModel* tvchannel =
-            new BrowseChannelModel(channelId, "", label, unqueId, type, thumbnail, commands, nullptr);*/
-        tvchannel->reset();
-        for (int i = 0; i < m_KodiRadioChannelList.length(); i++) {
-            QString thumbnail = fixUrl(
-                QString::fromStdString(QByteArray::fromPercentEncoding(
-                                           m_KodiRadioChannelList[i].toMap().value("thumbnail").toString().toUtf8())
-                                           .toStdString())
-                    .mid(8));
-            QStringList commands = {"PLAY"};
-            tvchannel->addchannelItem(m_KodiRadioChannelList[i].toMap().value("channelid").toString(), "",
-                                      m_KodiRadioChannelList[i].toMap().value("label").toString(), "", type, thumbnail,
-                                      commands);
-        }
-
-        if (entity) {
-            MediaPlayerInterface* me = static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
-            me->setBrowseModel(tvchannel);
-            tvchannel->update();
+    const ChannelCache& channels = param == "Radio" ? m_KodiRadioChannels : m_KodiTVChannels;
+    int                 generation = ++m_browseGeneration;
+    // logos stored since the model was built replace their remote URLs in a new model
+    if (m_channelModelSource == &channels && m_channelModelLogos == m_logoCache->revision()) {
+        // the model shown last is still up to date
+        if (m_channelModelRevision == channels.revision()) {
+            installChannelModel(tvchannel);
+            return;
         }
-    } else {
-        QString     channelId = "";
-        QString     label = "";
-        QString     thumbnail = "";
-        QString     unqueId = "";
-        QString     type = "tvchannellist";
-        QStringList commands = {};
-        /*BrowseTvChannelModel* tvchannel =
-            new BrowseTvChannelModel(channelId, "", label, unqueId, type, thumbnail, commands, nullptr);*/
-        /*BrowseChannelModel* tvchannel =
-            new BrowseChannelModel(channelId, "", label, unqueId, type, thumbnail, commands, nullptr);*/
-        tvchannel->reset();
-        //tvchannel =new BrowseChannelModel("", "", "", "", "", "", {}, nullptr);
-        for (int i = 0; i < m_KodiTVChannelList.length(); i++) {
-            QString thumbnail =
-                fixUrl(QString::fromStdString(QByteArray::fromPercentEncoding(
-                                                  m_KodiTVChannelList[i].toMap().value("thumbnail").toString().toUtf8())
-                                                  .toStdString())
-                           .mid(8));
+        // channels appended by the last load are added to the shown model, anything else needs a new model
+        if (m_channelModelRevision + 1 == channels.revision() &&
+            channels.unchangedCount() == m_channelModelRows) {
             QStringList commands = {"PLAY"};
-            tvchannel->addchannelItem(m_KodiTVChannelList[i].toMap().value("channelid").toString(), "",
-                                      m_KodiTVChannelList[i].toMap().value("label").toString(), "", type, thumbnail,
-                                      commands);
+            for (int channel = m_channelModelRows; channel < channels.count(); channel++) {
+                tvchannel->addchannelItem(QString::number(channels.at(channel).channelId), "",
+                                          channels.label(channel), "", "tvchannellist",
+                                          m_logoCache->url(channels.image(channel)), commands);
+            }
+            m_channelModelRevision = channels.revision();
+            m_channelModelRows = channels.count();
+            installChannelModel(tvchannel);
+            return;
         }
+    }
 
-        if (entity) {
-            MediaPlayerInterface* me = static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
-            me->setBrowseModel(tvchannel);
-            //tvchannel->update();
+    // the model is built on a worker from a copy of the channel list and installed in one step
+    ChannelListSnapshot snapshot;
+    snapshot.channels = channels;
+    snapshot.strings = m_strings;
+    snapshot.logos = m_logoCache->urls();
+    snapshot.type = "tvchannellist";
+    const ChannelCache* source = &channels;
+    int                 revision = channels.revision();
+    int                 rows = channels.count();
+    int                 logos = m_logoCache->revision();
+
+    QFutureWatcher<BrowseChannelModel*>* watcher = new QFutureWatcher<BrowseChannelModel*>(context_kodi);
+    QObject::connect(watcher, &QFutureWatcherBase::finished, context_kodi, [=]() {
+        watcher->deleteLater();
+        // a newer browse request replaced this one while it was built
+        if (generation != m_browseGeneration) {
+            watcher->result()->deleteLater();
+            return;
         }
-    }
+        m_channelModelSource = source;
+        m_channelModelRevision = revision;
+        m_channelModelRows = rows;
+        m_channelModelLogos = logos;
+        installChannelModel(watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run(buildChannelListModel, snapshot, thread()));
     /*}
 }
 // QObject::disconnect(this, &Kodi::requestReadygetCompleteTVChannelList, context_getCompleteTVChannelList,
@@ -864,11 +1048,11 @@ postRequest(
 }*/
 }
 
-void Kodi::updateCurrentPlayer(const QJsonDocument& resultJSONDocument) {
+void Kodi::updateCurrentPlayer(const QString& method, const QJsonDocument& resultJSONDocument) {
     // qCDebug(m_logCategory) << "test" << resultJSONDocument.object().value("result")["protocol"].toString();
     EntityInterface*      entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
     MediaPlayerInterface* me = static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
-    if (resultJSONDocument.object().value("id") == "Player.GetActivePlayers") {
+    if (method == "Player.GetActivePlayers") {
         if (entity) {
             if (resultJSONDocument.object().contains("result")) {
                 if (resultJSONDocument.object()["result"].toArray().count() != 0) {
@@ -879,35 +1063,35 @@ void Kodi::updateCurrentPlayer(const QJsonDocument& resultJSONDocument) {
                     }
                     m_currentkodiplayertype =
                         resultJSONDocument.object()["result"].toArray()[0].toObject()["type"].toString();
-                    if (m_currentkodiplayertype == "video") {
-                        QString jsonstring =
-                            "{\"jsonrpc\": \"2.0\", \"method\": \"Player.GetItem\",\"params\":"
-                            "{ \"properties\": [\"title\", \"album\", \"artist\", \"season\", \"episode\","
-                            " \"duration\", \"showtitle\", \"tvshowid\", \"thumbnail\", \"file\", \"fanart\","
-                            " \"streamdetails\"], \"playerid\": "
-                            "" +
-                            QString::number(m_currentkodiplayerid) + " }, \"id\": \"Player.GetItem\"}";
-                        postRequest(jsonstring);
-                        // m_flag = true;
-                    } else if (m_currentkodiplayertype == "audio") {
-                        QString jsonstring =
-                            "{\"jsonrpc\": \"2.0\", \"method\": \"Player.GetItem\",\"params\":"
-                            "{ \"properties\": [\"title\", \"album\", \"artist\", \"season\", "
-                            "\"episode\", \"duration\", \"showtitle\", \"tvshowid\", \"thumbnail\", "
-                            "\"file\", \"fanart\", \"streamdetails\"], \"playerid\": "
-                            "" +
-                            QString::number(m_currentkodiplayerid) + " }, \"id\": \"Player.GetItem\"}";
-                        postRequest(jsonstring);
+                    if (m_currentkodiplayertype == "video" || m_currentkodiplayertype == "audio") {
+                        // item and properties only depend on the player id, fetch both in one batch
+                        m_kodiParams.begin().addRaw("properties", KODI_PLAYER_ITEM_PROPERTIES);
+                        JsonRpcRequest getItem("Player.GetItem",
+                                               m_kodiParams.add("playerid", m_currentkodiplayerid).end());
+                        m_kodiParams.begin().addRaw("properties", KODI_PLAYER_PROPERTIES);
+                        JsonRpcRequest getProperties("Player.GetProperties",
+                                                     m_kodiParams.add("playerid", m_currentkodiplayerid).end());
+                        postBatchRequest(
+                            {{getItem, [=](const QJsonDocument& doc) { updateCurrentPlayer("Player.GetItem", doc); }},
+                             {getProperties,
+                              [=](const QJsonDocument& doc) { updateCurrentPlayer("Player.GetProperties", doc); }}});
                         // m_flag = true;
                     }
                 } else {
-                    // m_flag = false;
+                    // nothing plays, the entity is cleared once when the last player went away
+                    if (m_currentkodiplayerid != -1) {
+                        clearMediaPlayerEntity();
+                    }
+                    m_currentkodiplayerid = -1;
                 }
+                m_pollingScheduler->reportResult(m_pollingTaskCurrentPlayer, true);
             } else {
-                // m_flag = false;
+                // Kodi did not answer, poll less often until it does again
+                m_pollingScheduler->reportResult(m_pollingTaskCurrentPlayer, false);
             }
+            updatePollingInterval();
         }
-    } else if (resultJSONDocument.object().value("id") == "Player.GetItem") {
+    } else if (method == "Player.GetItem") {
         if (resultJSONDocument.object().contains("result")) {
             if (resultJSONDocument.object().value("result")["item"].toObject().contains("type")) {
                 if (me->mediaTitle() == resultJSONDocument.object().value("result")["item"]["title"].toString() &&
@@ -936,11 +1120,12 @@ void Kodi::updateCurrentPlayer(const QJsonDocument& resultJSONDocument) {
                             m_KodiCurrentPlayerThumbnail =
                                 resultJSONDocument.object().value("result")["item"]["thumbnail"].toString();
                             m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::PrepareDownload;
-                            QString jsonstring =
-                                "{\"jsonrpc\": \"2.0\", \"method\": \"Files.PrepareDownload\", "
-                                "\"params\": { \"path\": \"" +
-                                m_KodiCurrentPlayerThumbnail + "\" }, \"id\": \"Files.PrepareDownload\"}";
-                            postRequest(jsonstring);
+                            // the thumbnail is an image:// URL which may contain quotes and backslashes
+                            m_kodiParams.begin().add("path", m_KodiCurrentPlayerThumbnail);
+                            postRequest(JsonRpcRequest("Files.PrepareDownload", m_kodiParams.end()),
+                                        [=](const QJsonDocument& doc) {
+                                            updateCurrentPlayer("Files.PrepareDownload", doc);
+                                        });
                             // m_flag = false;
                         } else {
                             m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::GetProperties;
@@ -961,7 +1146,7 @@ void Kodi::updateCurrentPlayer(const QJsonDocument& resultJSONDocument) {
             // m_flag = false;
             m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::GetActivePlayers;
         }
-    } else if (resultJSONDocument.object().value("id") == "Files.PrepareDownload") {
+    } else if (method == "Files.PrepareDownload") {
         m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::GetProperties;
         if (resultJSONDocument.object().contains("result")) {
             if (resultJSONDocument.object().value("result")["protocol"].toString() == "http" &&
@@ -972,15 +1157,8 @@ void Kodi::updateCurrentPlayer(const QJsonDocument& resultJSONDocument) {
                         .arg(m_kodiJSONRPCUrl.scheme(), m_kodiJSONRPCUrl.host())
                         .arg(m_kodiJSONRPCUrl.port())
                         .arg(resultJSONDocument.object().value("result")["details"]["path"].toString()));
+                // the player properties were already requested in the batch together with Player.GetItem
                 m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::GetProperties;
-                QString jsonstring =
-                    "{\"jsonrpc\": \"2.0\", \"method\": \"Player.GetProperties\", "
-                    "\"params\": { \"playerid\":" +
-                    QString::number(m_currentkodiplayerid) +
-                    ", \"properties\": "
-                    "[\"totaltime\", \"time\", \"speed\"] }, "
-                    "\"id\": \"Player.GetProperties\"}";
-                postRequest(jsonstring);
             } else {
                 // m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::GetProperties;
                 // // m_flag = false;
@@ -989,7 +1167,7 @@ void Kodi::updateCurrentPlayer(const QJsonDocument& resultJSONDocument) {
             // m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::GetProperties;
             // // m_flag = false;
         }
-    } else if (resultJSONDocument.object().value("id") == "Player.GetProperties") {
+    } else if (method == "Player.GetProperties") {
         if (resultJSONDocument.object().contains("result")) {
             m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::GetActivePlayers;
 
@@ -1016,7 +1194,9 @@ void Kodi::updateCurrentPlayer(const QJsonDocument& resultJSONDocument) {
                     m_progressBarTimer->start();
                     entity->updateAttrByIndex(MediaPlayerDef::STATE, MediaPlayerDef::PLAYING);
                 } else {
-                    clearMediaPlayerEntity();
+                    // paused, the properties are polled with every item so title and image must stay
+                    m_progressBarTimer->stop();
+                    entity->updateAttrByIndex(MediaPlayerDef::STATE, MediaPlayerDef::States::IDLE);
                 }
             }
             /*QString jsonstring =
@@ -1030,9 +1210,8 @@ void Kodi::updateCurrentPlayer(const QJsonDocument& resultJSONDocument) {
     }
 }
 void Kodi::getCurrentPlayer() {
-    QString jsonstring =
-        "{\"jsonrpc\": \"2.0\", \"method\": \"Player.GetActivePlayers\", \"id\":\"Player.GetActivePlayers\"}";
-    postRequest(jsonstring);
+    postRequest(KODI_GET_ACTIVE_PLAYERS,
+                [=](const QJsonDocument& doc) { updateCurrentPlayer("Player.GetActivePlayers", doc); });
     /*QObject* contextgetCurrentPlayer = new QObject(context_kodi);
     QString  method = "Player.GetActivePlayers";
     QString  thumbnail = "";
@@ -1230,9 +1409,7 @@ void Kodi::getCurrentPlayer() {
       qCDebug(m_logCategory) << "kodi nr leer";
   }*/
 }
-void Kodi::tvheadendGetRequest(const QString& path, const QList<QPair<QString, QString> >& queryItems) {
-    // create new networkacces manager and request
-
+QNetworkRequest Kodi::tvheadendRequest(const QString& path, const QList<QPair<QString, QString> >& queryItems) {
     QNetworkRequest request;
 
     // connect to finish signal
@@ -1249,11 +1426,15 @@ void Kodi::tvheadendGetRequest(const QString& path, const QList<QPair<QString, Q
     }
 
     request.setUrl(url);
-    QString u = request.url().toString();
+    return request;
+}
+
+void Kodi::tvheadendGetRequest(const QString& path, const QList<QPair<QString, QString> >& queryItems) {
+    QNetworkRequest request = tvheadendRequest(path, queryItems);
+    // the connection check is answered before EPG and channel downloads
+    RequestQueue::Priority priority = path == "/api/serverinfo" ? RequestQueue::NowPlaying : RequestQueue::Background;
     // send the get request
-    m_tvreply = networkManagerTvHeadend->get(request);
-    QObject::connect(m_tvreply, &QNetworkReply::finished, context_kodi, [=]() {
-        QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    m_tvheadendRequestQueue->get(request, priority, [=](QNetworkReply* reply) {
         // QObject::connect(manager, &QNetworkAccessManager::finished, contextpostt, [=](QNetworkReply* reply) {
         QJsonDocument doc;
         if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 0) {
@@ -1262,25 +1443,22 @@ void Kodi::tvheadendGetRequest(const QString& path, const QList<QPair<QString, Q
                 qCWarning(m_logCategory) << errorString;
             }
 
-            QString       answer = reply->readAll();
+            QByteArray    answer = reply->readAll();
             QJsonDocument doc;
-            if (answer != "") {
+            if (!answer.isEmpty()) {
                 // convert to json
                 QJsonParseError parseerror;
-                doc = QJsonDocument::fromJson(answer.toUtf8(), &parseerror);
+                doc = QJsonDocument::fromJson(answer, &parseerror);
 
                 if (parseerror.error != QJsonParseError::NoError) {
                     qCWarning(m_logCategory) << "JSON error : " << parseerror.errorString();
                     return;
                 }
-                QVariant z = doc.object().value("entries").toArray();
                 if (doc.object().value("name") == "Tvheadend") {
                     emit requestReadyTvheadendConnectionCheck(doc);
                 } else if (doc.object().contains("entries") && !doc.object().contains("totalCount")) {
                     emit requestReadygetKodiChannelNumberToTVHeadendUUIDMapping(doc);
                     emit requestReadygetKodiChannelNumberToRadioHeadendUUIDMapping(doc);
-                } else if (doc.object().contains("entries") && doc.object().contains("totalCount")) {
-                    emit requestReadygetTVEPGfromTVHeadend(doc);
                 }
             } else {
                 if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 0) {
@@ -1307,182 +1485,53 @@ void Kodi::sendCommand(const QString& type, const QString& entityId, int command
 
     qCDebug(m_logCategory) << "Keypressed" << command;
     // qCDebug(m_logCategory) << "Key next" << entity->getCommandIndex()
-    QObject* contextsendCommand = new QObject(context_kodi);
     //
     if (command == MediaPlayerDef::C_PLAY) {
     } else if (command == MediaPlayerDef::C_PLAY_ITEM) {
         if (param.toMap().value("type") == "tvchannellist" || param.toMap().value("type") == "tvchannel") {
-            QObject::connect(context_kodi, &Kodi::requestReadyCommandPlay, contextsendCommand,
-                             [=](const QJsonDocument& resultJSONDocument) {
-                                 if (resultJSONDocument.object().contains("result")) {
-                                     if (resultJSONDocument.object().value("result") == "OK") {
-                                         EntityInterface* entity =
-                                             static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
-                                         entity->updateAttrByIndex(MediaPlayerDef::STATE,
-                                                                   MediaPlayerDef::States::PLAYING);
-                                         getCurrentPlayer();
-                                     }
-                                 }
-                                 contextsendCommand->deleteLater();
-                                 // QObject::disconnect(this, &Kodi::requestReadyCommandPlay,
-                                 // contextsendCommand, 0);
-                             });
-            QString jsonstring =
-                "{\"jsonrpc\": \"2.0\", \"method\": \"Player.Open\",\"params\":"
-                " {\"item\":{\"channelid\": " +
-                param.toMap().value("id").toString() + "}}, \"id\": \"sendCommandPlay\"}";
-            // qCDebug(m_logCategory).noquote() << jsonstring;
-            postRequest(jsonstring);
+            m_kodiParams.begin().beginObject("item").add("channelid", param.toMap().value("id").toInt()).endObject();
+            postRequest(JsonRpcRequest("Player.Open", m_kodiParams.end()),
+                        [=](const QJsonDocument& resultJSONDocument) {
+                            if (resultJSONDocument.object().contains("result")) {
+                                if (resultJSONDocument.object().value("result") == "OK") {
+                                    EntityInterface* entity =
+                                        static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
+                                    entity->updateAttrByIndex(MediaPlayerDef::STATE, MediaPlayerDef::States::PLAYING);
+                                    getCurrentPlayer();
+                                }
+                            }
+                        });
         }
     } else if (command == MediaPlayerDef::C_UP) {
-        QObject::connect(context_kodi, &Kodi::requestReadyCommandUp, contextsendCommand,
-                         [=](const QJsonDocument& resultJSONDocument) {
-                             if (resultJSONDocument.object().contains("result")) {
-                                 if (resultJSONDocument.object().value("result") == "OK") {
-                                 } else {
-                                 }
-                             }
-                             contextsendCommand->deleteLater();
-                         });
-        QString jsonstring =
-            "{\"jsonrpc\": \"2.0\", \"method\":"
-            " \"Input.Up\",\"params\": "
-            "{ }, \"id\":\"sendCommandUp\"}";
-        postRequest(jsonstring);
-        // qCDebug(m_logCategory).noquote() << jsonstring;
-        // postRequest("sendCommandPlay", jsonstring);
+        postRequest(KODI_INPUT_UP);
     } else if (command == MediaPlayerDef::C_MUTE) {
-        QObject::connect(context_kodi, &Kodi::requestReadyCommandMute, contextsendCommand,
-                         [=](const QJsonDocument& resultJSONDocument) {
-                             if (resultJSONDocument.object().contains("result")) {
-                                 if (resultJSONDocument.object().value("result") == "OK") {
-                                 } else {
-                                 }
-                             }
-                             contextsendCommand->deleteLater();
-                         });
-        QString jsonstring =
-            "{\"jsonrpc\": \"2.0\", \"method\":"
-            " \"Application.SetMute\",\"params\": "
-            "{ \"mute\": \"toggle\"}, \"id\":\"sendCommandMute\"}";
-        postRequest(jsonstring);
+        postRequest(KODI_TOGGLE_MUTE);
     } else if (command == MediaPlayerDef::C_OK) {
-        QObject::connect(context_kodi, &Kodi::requestReadyCommandOk, contextsendCommand,
-                         [=](const QJsonDocument& resultJSONDocument) {
-                             if (resultJSONDocument.object().contains("result")) {
-                                 if (resultJSONDocument.object().value("result") == "OK") {
-                                 } else {
-                                 }
-                             }
-                             contextsendCommand->deleteLater();
-                         });
-        QString jsonstring =
-            "{\"jsonrpc\": \"2.0\", \"method\":"
-            " \"Input.Select\",\"params\": "
-            "{ }, \"id\":\"sendCommandOk\"}";
-        postRequest(jsonstring);
+        postRequest(KODI_INPUT_SELECT);
     } else if (command == MediaPlayerDef::C_DOWN) {
-        QObject::connect(context_kodi, &Kodi::requestReadyCommandDown, contextsendCommand,
-                         [=](const QJsonDocument& resultJSONDocument) {
-                             if (resultJSONDocument.object().contains("result")) {
-                                 if (resultJSONDocument.object().value("result") == "OK") {
-                                 } else {
-                                 }
-                             }
-                             contextsendCommand->deleteLater();
-                         });
-        QString jsonstring =
-            "{\"jsonrpc\": \"2.0\", \"method\":"
-            " \"Input.Down\",\"params\": "
-            "{ }, \"id\":\"sendCommandDown\"}";
-        postRequest(jsonstring);
-        // qCDebug(m_logCategory).noquote() << jsonstring;
-        // postRequest("sendCommandPlay", jsonstring);
+        postRequest(KODI_INPUT_DOWN);
     } else if (command == MediaPlayerDef::C_RIGHT) {
-        QObject::connect(context_kodi, &Kodi::requestReadyCommandRight, contextsendCommand,
-                         [=](const QJsonDocument& resultJSONDocument) {
-                             if (resultJSONDocument.object().contains("result")) {
-                                 if (resultJSONDocument.object().value("result") == "OK") {
-                                 } else {
-                                 }
-                             }
-                             contextsendCommand->deleteLater();
-                         });
-        QString jsonstring =
-            "{\"jsonrpc\": \"2.0\", \"method\":"
-            " \"Input.Right\",\"params\": "
-            "{ }, \"id\":\"sendCommandRight\"}";
-        postRequest(jsonstring);
-        // qCDebug(m_logCategory).noquote() << jsonstring;
-        // postRequest("sendCommandPlay", jsonstring);
+        postRequest(KODI_INPUT_RIGHT);
     } else if (command == MediaPlayerDef::C_LEFT) {
-        QObject::connect(context_kodi, &Kodi::requestReadyCommandLeft, contextsendCommand,
-                         [=](const QJsonDocument& resultJSONDocument) {
-                             if (resultJSONDocument.object().contains("result")) {
-                                 if (resultJSONDocument.object().value("result") == "OK") {
-                                 } else {
-                                 }
-                             }
-                             contextsendCommand->deleteLater();
-                         });
-        QString jsonstring =
-            "{\"jsonrpc\": \"2.0\", \"method\":"
-            " \"Input.Left\",\"params\": "
-            "{ }, \"id\":\"sendCommandLeft\"}";
-        postRequest(jsonstring);
+        postRequest(KODI_INPUT_LEFT);
     } else if (command == 35) {
-        QObject::connect(context_kodi, &Kodi::requestReadyCommandBack, contextsendCommand,
-                         [=](const QJsonDocument& resultJSONDocument) {
-                             if (resultJSONDocument.object().contains("result")) {
-                                 if (resultJSONDocument.object().value("result") == "OK") {
-                                 } else {
-                                 }
-                             }
-                             contextsendCommand->deleteLater();
-                         });
-        QString jsonstring =
-            "{\"jsonrpc\": \"2.0\", \"method\":"
-            " \"Input.Back\",\"params\": "
-            "{ }, \"id\":\"sendCommandBack\"}";
-        postRequest(jsonstring);
+        postRequest(KODI_INPUT_BACK);
     } else if (command == MediaPlayerDef::C_MENU) {
-        QObject::connect(context_kodi, &Kodi::requestReadyCommandMenu, contextsendCommand,
-                         [=](const QJsonDocument& resultJSONDocument) {
-                             if (resultJSONDocument.object().contains("result")) {
-                                 if (resultJSONDocument.object().value("result") == "OK") {
-                                 } else {
-                                 }
-                             }
-                             contextsendCommand->deleteLater();
-                         });
-        QString jsonstring =
-            "{\"jsonrpc\": \"2.0\", \"method\":"
-            " \"Input.ContextMenu\",\"params\": "
-            "{ }, \"id\":\"sendCommandMenu\"}";
-        postRequest(jsonstring);
+        postRequest(KODI_INPUT_CONTEXTMENU);
     } else if (command == MediaPlayerDef::C_CHANNEL_UP) {
         EntityInterface* entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
 
         MediaPlayerInterface* me = static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
 
         if (me->mediaType() == "channel") {
-            QObject::connect(context_kodi, &Kodi::requestReadyCommandChannelUp, contextsendCommand,
-                             [=](const QJsonDocument& resultJSONDocument) {
-                                 if (resultJSONDocument.object().contains("result")) {
-                                     if (resultJSONDocument.object().value("result") == "OK") {
-                                         m_progressBarTimer->stop();
-                                         getCurrentPlayer();
-                                     }
-                                 }
-                                 contextsendCommand->deleteLater();
-                                 // QObject::disconnect(this, &Kodi::requestReadyCommandNext,
-                                 // contextsendCommand, 0);
-                             });
-            QString jsonstring =
-                "{\"jsonrpc\": \"2.0\", \"method\":"
-                " \"Input.ExecuteAction\",\"params\": "
-                "{ \"action\": \"channelup\" }, \"id\":\"sendCommandChannelUp\"}";
-            postRequest(jsonstring);
+            postRequest(KODI_CHANNEL_UP, [=](const QJsonDocument& resultJSONDocument) {
+                if (resultJSONDocument.object().contains("result")) {
+                    if (resultJSONDocument.object().value("result") == "OK") {
+                        m_progressBarTimer->stop();
+                        getCurrentPlayer();
+                    }
+                }
+            });
         }
     } else if (command == MediaPlayerDef::C_CHANNEL_DOWN) {
         EntityInterface* entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
@@ -1490,87 +1539,55 @@ void Kodi::sendCommand(const QString& type, const QString& entityId, int command
         MediaPlayerInterface* me = static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
 
         if (me->mediaType() == "channel") {
-            QObject::connect(context_kodi, &Kodi::requestReadyCommandChannelDown, contextsendCommand,
-                             [=](const QJsonDocument& resultJSONDocument) {
-                                 if (resultJSONDocument.object().contains("result")) {
-                                     if (resultJSONDocument.object().value("result") == "OK") {
-                                         m_progressBarTimer->stop();
-                                         getCurrentPlayer();
-                                     }
-                                 }
-                                 contextsendCommand->deleteLater();
-                                 // QObject::disconnect(this,
-                                 // &Kodi::requestReadyCommandPrevious, contextsendCommand,
-                                 // 0);
-                             });
-            QString jsonstring =
-                "{\"jsonrpc\": \"2.0\","
-                " \"method\": \"Input.ExecuteAction\","
-                "\"params\": { \"action\": \"channeldown\" }, "
-                "\"id\": \"sendCommandChannelDown\"}";
-            postRequest(jsonstring);
+            postRequest(KODI_CHANNEL_DOWN, [=](const QJsonDocument& resultJSONDocument) {
+                if (resultJSONDocument.object().contains("result")) {
+                    if (resultJSONDocument.object().value("result") == "OK") {
+                        m_progressBarTimer->stop();
+                        getCurrentPlayer();
+                    }
+                }
+            });
         }
     } else if (command == MediaPlayerDef::C_QUEUE) {
     } else if (command == MediaPlayerDef::C_STOP) {
-        QObject::connect(context_kodi, &Kodi::requestReadyCommandStop, contextsendCommand,
-                         [=](const QJsonDocument& resultJSONDocument) {
-                             if (resultJSONDocument.object().contains("result")) {
-                                 if (resultJSONDocument.object().value("result") == "OK") {
-                                     m_progressBarTimer->stop();
-                                     m_currentkodiplayertype = "unknown";
-                                     m_currentkodiplayerid = -1;
-                                     m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::Stopped;
-                                     // m_flag = false;
-                                     clearMediaPlayerEntity();
-                                 }
-                             }
-                             contextsendCommand->deleteLater();
-                             // QObject::disconnect(this, &Kodi::requestReadyCommandPause, contextsendCommand, 0);
-                         });
-        QString jsonstring =
-            "{\"jsonrpc\": \"2.0\", \"method\": \"Player.Stop\","
-            " \"params\": { \"playerid\": " +
-            QString::number(m_currentkodiplayerid) + " },\"id\": \"sendCommandStop\"}";
-        postRequest(jsonstring);
+        m_kodiParams.begin().add("playerid", m_currentkodiplayerid);
+        postRequest(JsonRpcRequest("Player.Stop", m_kodiParams.end()),
+                    [=](const QJsonDocument& resultJSONDocument) {
+                        if (resultJSONDocument.object().contains("result")) {
+                            if (resultJSONDocument.object().value("result") == "OK") {
+                                m_progressBarTimer->stop();
+                                m_currentkodiplayertype = "unknown";
+                                m_currentkodiplayerid = -1;
+                                m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::Stopped;
+                                // m_flag = false;
+                                clearMediaPlayerEntity();
+                            }
+                        }
+                    });
     } else if (command == MediaPlayerDef::C_PAUSE) {
-        QObject::connect(context_kodi, &Kodi::requestReadyCommandPause, contextsendCommand,
-                         [=](const QJsonDocument& resultJSONDocument) {
-                             if (resultJSONDocument.object().contains("result")) {
-                                 if (resultJSONDocument.object().value("result") == "OK") {
-                                     qCDebug(m_logCategory) << "Pause";
-                                 }
-                             }
-                             contextsendCommand->deleteLater();
-                             // QObject::disconnect(this, &Kodi::requestReadyCommandPause, contextsendCommand, 0);
-                         });
-        QString jsonstring =
-            "{\"jsonrpc\": \"2.0\", \"method\": \"Player.PlayPause\","
-            " \"params\": { \"playerid\": " +
-            QString::number(m_currentkodiplayerid) + " },\"id\": \"sendCommandPause\"}";
-        postRequest(jsonstring);
+        m_kodiParams.begin().add("playerid", m_currentkodiplayerid);
+        postRequest(JsonRpcRequest("Player.PlayPause", m_kodiParams.end()),
+                    [=](const QJsonDocument& resultJSONDocument) {
+                        if (resultJSONDocument.object().contains("result")) {
+                            if (resultJSONDocument.object().value("result") == "OK") {
+                                qCDebug(m_logCategory) << "Pause";
+                            }
+                        }
+                    });
     } else if (command == MediaPlayerDef::C_NEXT) {
         EntityInterface* entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
 
         MediaPlayerInterface* me = static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
 
         if (me->mediaType() == "channel") {
-            QObject::connect(context_kodi, &Kodi::requestReadyCommandNext, contextsendCommand,
-                             [=](const QJsonDocument& resultJSONDocument) {
-                                 if (resultJSONDocument.object().contains("result")) {
-                                     if (resultJSONDocument.object().value("result") == "OK") {
-                                         m_progressBarTimer->stop();
-                                         getCurrentPlayer();
-                                     }
-                                 }
-                                 contextsendCommand->deleteLater();
-                                 // QObject::disconnect(this, &Kodi::requestReadyCommandNext,
-                                 // contextsendCommand, 0);
-                             });
-            QString jsonstring =
-                "{\"jsonrpc\": \"2.0\", \"method\":"
-                " \"Input.ExecuteAction\",\"params\": "
-                "{ \"action\": \"channelup\" }, \"id\":\"sendCommandNext\"}";
-            postRequest(jsonstring);
+            postRequest(KODI_CHANNEL_UP, [=](const QJsonDocument& resultJSONDocument) {
+                if (resultJSONDocument.object().contains("result")) {
+                    if (resultJSONDocument.object().value("result") == "OK") {
+                        m_progressBarTimer->stop();
+                        getCurrentPlayer();
+                    }
+                }
+            });
         }
     } else if (command == MediaPlayerDef::C_PREVIOUS) {
         EntityInterface* entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
@@ -1578,48 +1595,48 @@ void Kodi::sendCommand(const QString& type, const QString& entityId, int command
         MediaPlayerInterface* me = static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
 
         if (me->mediaType() == "channel") {
-            QObject::connect(context_kodi, &Kodi::requestReadyCommandPrevious, contextsendCommand,
-                             [=](const QJsonDocument& resultJSONDocument) {
-                                 if (resultJSONDocument.object().contains("result")) {
-                                     if (resultJSONDocument.object().contains("result")) {
-                                         m_progressBarTimer->stop();
-                                         getCurrentPlayer();
-                                     }
-                                     KodiApplicationProperties();
-                                 }
-                                 contextsendCommand->deleteLater();
-                                 // QObject::disconnect(this,
-                                 // &Kodi::requestReadyCommandPrevious, contextsendCommand,
-                                 // 0);
-                             });
-            QString jsonstring =
-                "{\"jsonrpc\": \"2.0\","
-                " \"method\": \"Input.ExecuteAction\","
-                "\"params\": { \"action\": \"channeldown\" }, "
-                "\"id\": \"sendCommandPrevious\"}";
-            postRequest(jsonstring);
+            postRequest(KODI_CHANNEL_DOWN, [=](const QJsonDocument& resultJSONDocument) {
+                if (resultJSONDocument.object().contains("result")) {
+                    if (resultJSONDocument.object().contains("result")) {
+                        m_progressBarTimer->stop();
+                        getCurrentPlayer();
+                    }
+                    KodiApplicationProperties();
+                }
+            });
         }
     } else if (command == MediaPlayerDef::C_VOLUME_SET) {
         /*qCDebug(m_logCategory)
             << "Volume"
             << param.toString();  // putRequest("/v1/me/player/volume" {{ "volume_percent", param.toString() }} "");*/
-        QObject::connect(context_kodi, &Kodi::requestReadyCommandVolume, contextsendCommand,
-                         [=](const QJsonDocument& resultJSONDocument) {
-                             if (resultJSONDocument.object().contains("result")) {
-                                 EntityInterface* entity =
-                                     static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
-                                 entity->updateAttrByIndex(MediaPlayerDef::VOLUME,
-                                                           resultJSONDocument.object().value("result").toInt());
-                             }
-                             contextsendCommand->deleteLater();
-                         });
-        QString jsonstring =
-            "{\"jsonrpc\": \"2.0\", \"method\":"
-            " \"Application.SetVolume\",\"params\": "
-            "{\"volume\": " +
-            param.toString() + " }, \"id\":\"sendCommandVolume\"}";
-        postRequest(jsonstring);
+        m_kodiParams.begin().add("volume", param.toInt());
+        postCoalescedRequest(JsonRpcRequest("Application.SetVolume", m_kodiParams.end()),
+                             [=](const QJsonDocument& resultJSONDocument) {
+                                 if (resultJSONDocument.object().contains("result")) {
+                                     EntityInterface* entity =
+                                         static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
+                                     entity->updateAttrByIndex(MediaPlayerDef::VOLUME,
+                                                               resultJSONDocument.object().value("result").toInt());
+                                 }
+                             });
         // {"jsonrpc":"2.0","method":"Application.SetVolume","id":1,"params":{"volume":64}}
+    } else if (command == MediaPlayerDef::C_SEEK) {
+        int position = param.toInt();
+        m_kodiParams.begin().add("playerid", m_currentkodiplayerid).beginObject("value").beginObject("time");
+        m_kodiParams.add("hours", position / 3600).add("minutes", (position / 60) % 60).add("seconds", position % 60);
+        m_kodiParams.add("milliseconds", 0).endObject().endObject();
+        postCoalescedRequest(JsonRpcRequest("Player.Seek", m_kodiParams.end()),
+                             [=](const QJsonDocument& resultJSONDocument) {
+                                 if (resultJSONDocument.object().value("result").toObject().contains("time")) {
+                                     QJsonObject time = resultJSONDocument.object().value("result")["time"].toObject();
+                                     m_progressBarPosition = time.value("hours").toInt() * 3600 +
+                                                             time.value("minutes").toInt() * 60 +
+                                                             time.value("seconds").toInt();
+                                     EntityInterface* entity =
+                                         static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
+                                     entity->updateAttrByIndex(MediaPlayerDef::MEDIAPROGRESS, m_progressBarPosition);
+                                 }
+                             });
     } else if (command == MediaPlayerDef::C_SEARCH) {
         // search(param.toString());
     } else if (command == MediaPlayerDef::C_GETMEDIAPLAYEREPGVIEW) {
@@ -1654,7 +1671,102 @@ void Kodi::sendCommand(const QString& type, const QString& entityId, int command
     }*/
 }
 
-void Kodi::postRequest(const QString& param) {
+void Kodi::postRequest(const JsonRpcRequest& request, const KodiReplyHandler& handler) {
+    QByteArray body;
+    int        id = registerKodiRequest({request, handler}, &body);
+    sendKodiRequest(body, {id});
+}
+
+void Kodi::postCoalescedRequest(const JsonRpcRequest& jsonRpcRequest, const KodiReplyHandler& handler) {
+    // only the latest value is kept while a request of the same method is on its way
+    const QByteArray&     method = jsonRpcRequest.method();
+    KodiCoalescedRequest& request = m_kodiCoalescedRequests[method];
+    request.request = jsonRpcRequest;
+    request.handler = handler;
+    request.pending = true;
+    if (!request.inFlight) {
+        sendCoalescedRequest(method);
+    }
+}
+
+void Kodi::sendCoalescedRequest(const QByteArray& method) {
+    KodiCoalescedRequest& request = m_kodiCoalescedRequests[method];
+    KodiReplyHandler      handler = request.handler;
+    request.inFlight = true;
+    request.pending = false;
+    postRequest(request.request, [=](const QJsonDocument& doc) {
+        auto it = m_kodiCoalescedRequests.find(method);
+        if (it == m_kodiCoalescedRequests.end()) {
+            return;
+        }
+        if (it->pending) {
+            // the reply is already outdated, send the newer value instead of showing it
+            sendCoalescedRequest(method);
+        } else {
+            it->inFlight = false;
+            if (handler) {
+                handler(doc);
+            }
+        }
+    });
+}
+
+void Kodi::postBatchRequest(const QList<KodiRequest>& requests) {
+    // JSON-RPC 2.0 batch: Kodi answers with an array, which is fanned out to the handlers in dispatchKodiReply()
+    QByteArray batch("[");
+    QList<int> ids;
+    for (const KodiRequest& request : requests) {
+        QByteArray body;
+        ids.append(registerKodiRequest(request, &body));
+        if (batch.size() > 1) {
+            batch.append(',');
+        }
+        batch.append(body);
+    }
+    batch.append(']');
+    sendKodiRequest(batch, ids);
+}
+
+int Kodi::registerKodiRequest(const KodiRequest& request, QByteArray* body) {
+    // every request gets its own id, so concurrent calls of the same method never see each other's replies
+    int id = ++m_globalKodiRequestID;
+    m_kodiPendingRequests.insert(id, {request.request.method(), request.handler, false});
+    *body = request.request.body(id);
+    return id;
+}
+
+void Kodi::completeKodiRequest(int id, const QJsonDocument& doc) {
+    auto it = m_kodiPendingRequests.find(id);
+    if (it == m_kodiPendingRequests.end()) {
+        return;
+    }
+    // remove the entry before calling the handler, it may send new requests or disconnect
+    KodiReplyHandler handler = it->handler;
+    m_kodiPendingRequests.erase(it);
+    if (handler) {
+        handler(doc);
+    }
+}
+
+void Kodi::sendKodiRequest(const QByteArray& body, const QList<int>& ids) {
+    if (m_flagKodiEventServerOnline && m_tcpSocketKodiEventServer->state() == QTcpSocket::ConnectedState) {
+        // send the request as raw JSON-RPC over the already open event server socket, the reply is handled in
+        // readTcpData(). HTTP is only used as fallback while the socket is down.
+        for (int id : ids) {
+            m_kodiPendingRequests[id].eventServer = true;
+        }
+        m_tcpSocketKodiEventServer->write(body);
+        // a reply Kodi drops while the socket stays open would keep the request and its coalesced command in flight
+        QTimer::singleShot(KODI_REQUEST_TIMEOUT, context_kodi, [=]() {
+            for (int id : ids) {
+                if (m_kodiPendingRequests.contains(id)) {
+                    completeKodiRequest(id, QJsonDocument());
+                }
+            }
+        });
+        return;
+    }
+
     // create new networkacces manager and request
     // QNetworkAccessManager* manager = new QNetworkAccessManager(this);
     QNetworkRequest request(m_kodiJSONRPCUrl);
@@ -1662,161 +1774,201 @@ void Kodi::postRequest(const QString& param) {
     // const QString          u = callfunction;
 
     // set headers
-    QByteArray paramutf8 = param.toUtf8();
-
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
 
     // send the post request
-    // qCDebug(m_logCategory) << "POST:" << request.url() << paramutf8;
+    // qCDebug(m_logCategory) << "POST:" << request.url() << body;
 
-    m_kodireply = networkManagerKodi->post(request, paramutf8);
-    // qCDebug(m_logCategory) << param;
-    // connect to finish signal
-    QObject::connect(m_kodireply,
-                     static_cast<void (QNetworkReply::*)(QNetworkReply::NetworkError)>(&QNetworkReply::error),
-                     context_kodi, [=]() {
-                         qCDebug(m_logCategory) << "1";
-                         QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-                         // qCDebug(m_logCategory) << reply->error();
-                     });
-    QObject::connect(m_kodireply, &QNetworkReply::finished, context_kodi, [=]() {
-        QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-        // QObject::connect(manager, &QNetworkAccessManager::finished, contextpostt, [=](QNetworkReply* reply) {
+    // a batch is sent with the priority of its most urgent request
+    RequestQueue::Priority priority = RequestQueue::Background;
+    for (int id : ids) {
+        priority = qMin(priority, kodiRequestPriority(m_kodiPendingRequests.value(id).method));
+    }
+
+    // requests aborted in disconnect() never call back, the pending requests are dropped there
+    m_kodiRequestQueue->post(request, body, priority, [=](QNetworkReply* reply) {
         QJsonDocument doc;
-        // qCDebug(m_logCategory) << reply->error();
-        if (reply->error() == QNetworkReply::OperationCanceledError) {
-            qCDebug(m_logCategory) << "2";
-        }
-        if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200) {
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status == 200) {
             if (reply->error()) {
                 QString errorString = reply->errorString();
                 qCWarning(m_logCategory) << errorString;
             }
-            QString answer = reply->readAll();
+            QByteArray answer = reply->readAll();
             // qCDebug(m_logCategory).noquote() << "RECEIVED:" << answer;
-            // QVariantMap map;
 
-            if (answer != "") {
+            if (!answer.isEmpty()) {
                 // convert to json
                 QJsonParseError parseerror;
-                doc = QJsonDocument::fromJson(answer.toUtf8(), &parseerror);
-                QString strJson(doc.toJson(QJsonDocument::Compact));
-                // qCDebug(m_logCategory) << strJson;
+                doc = QJsonDocument::fromJson(answer, &parseerror);
                 if (parseerror.error != QJsonParseError::NoError) {
                     qCWarning(m_logCategory) << "JSON error : " << parseerror.errorString();
-                    return;
-                }
-                if (doc.object().value("id") == 2) {
-                    QString h = "gg";
-                }
-                if (doc.object().value("id").toString() == "getKodiAvailableTVChannelList") {
-                    emit requestReadygetKodiAvailableTVChannelList(doc);
-                } else if (doc.object().value("id").toString() == "getKodiAvailableRadioChannelList") {
-                    emit requestReadygetKodiAvailableRadioChannelList(doc);
-                } else if (doc.object().value("id").toString() == "getSingleTVChannelList") {
-                    emit requestReadygetSingleTVChannelList(doc);
-                } else if (doc.object().value("id").toString() == "getCompleteTVChannelList") {
-                    emit requestReadygetCompleteTVChannelList(doc);
-                } else if (doc.object().value("id").toString() == "getCompleteRadioChannelList") {
-                    emit requestReadygetCompleteRadioChannelList(doc);
-                } else if (doc.object().value("id").toString() == "epg") {
-                    emit requestReadygetEPG(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandPlay") {
-                    emit requestReadyCommandPlay(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandPause") {
-                    emit requestReadyCommandPause(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandStop") {
-                    emit requestReadyCommandStop(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandNext") {
-                    emit requestReadyCommandNext(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandPrevious") {
-                    emit requestReadyCommandPrevious(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandUp") {
-                    emit requestReadyCommandUp(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandDown") {
-                    emit requestReadyCommandDown(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandLeft") {
-                    emit requestReadyCommandLeft(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandRight") {
-                    emit requestReadyCommandRight(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandOk") {
-                    emit requestReadyCommandOk(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandMenu") {
-                    emit requestReadyCommandMenu(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandBack") {
-                    emit requestReadyCommandBack(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandChannelUp") {
-                    emit requestReadyCommandChannelUp(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandChannelDown") {
-                    emit requestReadyCommandChannelDown(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandMute") {
-                    emit requestReadyCommandMute(doc);
-                } else if (doc.object().value("id").toString() == "sendCommandVolume") {
-                    emit requestReadyCommandVolume(doc);
-                } else if (doc.object().value("id").toString() == "ConnectionCheck") {
-                    emit requestReadyKodiConnectionCheck(doc);
-                } else if (doc.object().value("id").toString() == "Application.GetProperties") {
-                    emit requestReadyKodiApplicationProperties(doc);
-                } else if (doc.object().value("id").toString() == "Playlist.GetItems") {
-                    emit requestReadygetUserPlaylists(doc);
-               } else if (doc.object().value("id").toString() == "Player.GetActivePlayers" ||
-                           doc.object().value("id").toString() == "Player.GetItem" ||
-                           doc.object().value("id").toString() == "Player.GetProperties" ||
-                           doc.object().value("id").toString() == "Files.PrepareDownload") {
-                    emit requestReadygetCurrentPlayer(doc);
                 } else {
-                    qCWarning(m_logCategory) << "no callback function defined ";
-                }
-            } else {
-                if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 0) {
-                    emit requestReadyKodiConnectionCheck(doc);
+                    dispatchKodiReply(doc);
                 }
             }
-        } else {
-            if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 0) {
-                emit requestReadyKodiConnectionCheck(doc);
+        }
+        // complete the requests which did not get an answer with an empty document
+        bool pingFailed = false;
+        for (int id : ids) {
+            if (m_kodiPendingRequests.contains(id)) {
+                pingFailed |= m_kodiPendingRequests.value(id).method == "JSONRPC.Ping";
+                completeKodiRequest(id, QJsonDocument());
             }
         }
-        // reply->deleteLater();
-        // contextpostt->deleteLater();
-        // manager->deleteLater();
+        if (status == 0 && !pingFailed) {
+            qCWarning(m_logCategory) << reply->errorString();
+            kodiconnectioncheck(QJsonDocument());
+        }
     });
 }
 
+RequestQueue::Priority Kodi::kodiRequestPriority(const QByteArray& method) const {
+    if (method == "JSONRPC.Ping" || method.startsWith("Player.Get") || method == "Files.PrepareDownload" ||
+        method == "Application.GetProperties") {
+        return RequestQueue::NowPlaying;
+    } else if (method.startsWith("PVR.") || method.startsWith("Playlist.")) {
+        return RequestQueue::Background;
+    }
+    // everything else is triggered by the user
+    return RequestQueue::Interactive;
+}
+
+void Kodi::dispatchKodiReply(const QJsonDocument& doc) {
+    if (doc.isArray()) {
+        for (const QJsonValue& item : doc.array()) {
+            dispatchKodiReply(QJsonDocument(item.toObject()));
+        }
+        return;
+    }
+    int id = doc.object().value("id").toInt();
+    if (m_kodiPendingRequests.contains(id)) {
+        completeKodiRequest(id, doc);
+    } else {
+        qCWarning(m_logCategory) << "no callback function defined " << id;
+    }
+}
+
 void Kodi::onPollingEPGLoadTimerTimeout() {
-    //
-    if (m_mapKodiChannelNumberToTVHeadendUUID.count() > 0) {
-        int temp_Timestamp = (m_EPGExpirationTimestamp - (QDateTime(QDate::currentDate()).toTime_t()));
-        if (temp_Timestamp <= 0) {
-            if (m_currentEPGchannelToLoad == m_epgChannelList.count()) {
-                m_EPGExpirationTimestamp =
-                    QDateTime(QDate::currentDate()).toTime_t() + (m_tvProgrammExpireTimeInHours * 3600);
-                m_currentEPGchannelToLoad = 0;
-            } else {
-                getTVEPGfromTVHeadend(m_epgChannelList[m_currentEPGchannelToLoad]);
-                m_currentEPGchannelToLoad++;
+    uint now = QDateTime::currentDateTime().toTime_t();
+    // channels which failed in the last cycle are requested again, otherwise all of them once the programme expired
+    QList<int> channels = m_epgChannelsToLoad;
+    if (channels.isEmpty() && static_cast<int>(now) >= m_EPGExpirationTimestamp) {
+        channels = m_epgChannelList;
+    }
+    if (m_mapKodiChannelNumberToTVHeadendUUID.isEmpty() || m_epgRequestsPending > 0 || channels.isEmpty()) {
+        scheduleEPGLoad();
+        return;
+    }
+    m_epgChannelsToLoad.clear();
+    // all channels are requested at once, the request queue keeps at most
+    // m_tvheadendMaxConnections of them running
+    uint from = now - static_cast<uint>(m_epgRetentionInHours) * 3600;
+    uint until = now + static_cast<uint>(m_epgLookAheadInHours) * 3600;
+    // after a restored snapshot the first cycle only fetches the range beyond it
+    from = qMax(from, m_epgRestoredUntil);
+    // replies of earlier cycles are no longer counted
+    int generation = ++m_epgGeneration;
+    m_epgRequestsPending = 0;
+    m_epgEventsLoaded = 0;
+    for (int channel : channels) {
+        if (from >= until) {
+            break;
+        }
+        bool requested = getTVEPGfromTVHeadend(channel, from, until, [=](bool valid, int events) {
+            if (generation != m_epgGeneration) {
+                return;
             }
+            if (!valid) {
+                m_epgChannelsToLoad.append(channel);
+            }
+            m_epgEventsLoaded += events;
+            if (--m_epgRequestsPending > 0) {
+                return;
+            }
+            // TVHeadend answers with an empty grid for UUIDs it does not know, e.g. after it recreated its channels,
+            // the cycle is started again once the channels are mapped anew
+            if (m_epgChannelsToLoad.isEmpty() && m_epgEventsLoaded == 0) {
+                dropChannelMappings();
+                return;
+            }
+            finishEPGLoad(until);
+        });
+        if (requested) {
+            m_epgRequestsPending++;
         } else {
-            // tvheadendGetRequest("/api/serverinfo", {});
+            m_epgChannelsToLoad.append(channel);
         }
-        // qCDebug(m_logCategory) << "urls" << m_tvheadendJSONUrl;
     }
+    if (m_epgRequestsPending == 0) {
+        finishEPGLoad(until);
+    } else {
+        scheduleEPGLoad();
+    }
+}
+
+void Kodi::scheduleEPGLoad() {
+    // the loader sleeps while there is nothing it could load or while a cycle waits for its replies
+    if (m_mapKodiChannelNumberToTVHeadendUUID.isEmpty() || m_epgChannelList.isEmpty() || !m_flagTVHeadendOnline ||
+        m_epgRequestsPending > 0) {
+        m_pollingScheduler->stop(m_pollingTaskEPGLoad);
+        return;
+    }
+    // failed channels are retried soon, otherwise the loader wakes up when the programme expires
+    int delay = KODI_EPG_LOAD_INTERVAL;
+    if (m_epgChannelsToLoad.isEmpty()) {
+        qint64 left = static_cast<qint64>(m_EPGExpirationTimestamp) - QDateTime::currentDateTime().toTime_t();
+        delay = static_cast<int>(qMax(static_cast<qint64>(0), left) * 1000);
+    }
+    m_pollingScheduler->start(m_pollingTaskEPGLoad, delay);
+}
+
+void Kodi::finishEPGLoad(uint until) {
+    // the cycle is only complete once every channel answered, failed ones are requested again by the next tick
+    if (!m_epgChannelsToLoad.isEmpty()) {
+        scheduleEPGLoad();
+        return;
+    }
+    uint now = QDateTime::currentDateTime().toTime_t();
+    m_EPGExpirationTimestamp = static_cast<int>(now) + (m_tvProgrammExpireTimeInHours * 3600);
+    // a window extended by the grid before stays
+    m_epgRestoredUntil = 0;
+    m_epgLoadedUntil = qMax(m_epgLoadedUntil, until);
+    uint retention = static_cast<uint>(m_epgRetentionInHours) * 3600;
+    int  evicted = m_currentEPG.evict(now - retention);
+    // the pool only keeps the texts which are still in use
+    StringPool strings;
+    m_currentEPG.translateStrings(&strings);
+    m_KodiTVChannels.translateStrings(&strings);
+    m_KodiRadioChannels.translateStrings(&strings);
+    m_strings = strings;
+    qCDebug(m_logCategory) << "EPG holds" << m_currentEPG.count() << "events in" << m_currentEPG.footprint()
+                           << "bytes," << evicted << "finished events evicted";
+    writeEPG();
+    scheduleEPGLoad();
 }
 void Kodi::onPollingTimerTimeout() {
     if (m_flagKodiOnline) {
         // qCDebug(m_logCategory) << "polling";
         getCurrentPlayer();
-        if (m_timer == 10) {
-            KodiApplicationProperties();
-            postRequest(
-                "{ \"jsonrpc\": \"2.0\","
-                " \"method\": \"JSONRPC.Ping\", \"params\": {  },"
-                " \"id\":\"ConnectionCheck\"}");
-            m_timer = 0;
-        } else {
-            m_timer++;
-        }
+    }
+}
+
+void Kodi::onPollingConnectionCheckTimeout() {
+    if (m_flagKodiOnline) {
+        KodiApplicationProperties();
+        postRequest(KODI_PING, [=](const QJsonDocument& doc) { kodiconnectioncheck(doc); });
+    }
+}
+
+void Kodi::updatePollingInterval() {
+    if (m_flagKodiEventServerOnline) {
+        // player state is pushed over the socket, polling is only a safety net
+        m_pollingScheduler->setInterval(m_pollingTaskCurrentPlayer, KODI_POLLING_INTERVAL_EVENTSERVER);
+    } else if (m_currentkodiplayerid != -1) {
+        m_pollingScheduler->setInterval(m_pollingTaskCurrentPlayer, KODI_POLLING_INTERVAL);
     } else {
+        m_pollingScheduler->setInterval(m_pollingTaskCurrentPlayer, KODI_POLLING_INTERVAL_IDLE);
     }
 }
 
@@ -1829,12 +1981,9 @@ void Kodi::onProgressBarTimerTimeout() {
 }
 
 void Kodi::showepg() {
-    QObject* contextshowepg = new QObject(context_kodi);
     /*QObject::connect(
         context_kodi, &Kodi::requestReadygetEPG, contextshowepg, [=](const QJsonDocument& resultJSONDocument) {*/
             qCDebug(m_logCategory) << "finished request showepg()";
-            EntityInterface* entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
-            QDateTime        timestamp;
 
             QString     channelId = "2";
             QString     label = "";
@@ -1849,101 +1998,12 @@ void Kodi::showepg() {
             // epgitem->~BrowseEPGModel();
             // epgitem = new BrowseEPGModel("channelId", 20, 1, 400, 40, "epglist", "#FF0000", "#FFFFFF",
             //                                           "Test", "", "", "", "", "", commands, nullptr);
+            // the grid starts with the previous full hour, it keeps the origin while it is rebuilt
             QDateTime current = QDateTime::currentDateTime();
-            int       hnull = current.time().hour() - 1;
-            int       dnull = current.date().day();
-            int       mnull = current.date().month();
-            int       ynull = current.date().year();
-            qCDebug(m_logCategory) << "1 for start";
-            for (int i = hnull; i < (hnull + 80); i++) {
-                qCDebug(m_logCategory) << "xcoor" << ((i - hnull) * 360);
-                if (((((i - hnull) * 360) + 170)+360) > 15000) {
-                    break;
-                }
-                if (i < 24) {
-                    epgitem->addEPGItem(QString::number(i), ((i - hnull) * 360) + 170, 0, 360, 40, "epg", "#FF0000",
-                                        "#FFFFFF",
-                                        QString::number(i) + " Uhr  " + QString::number(dnull) + "." +
-                                            QString::number(mnull) + "." + QString::number(ynull),
-                                        "", "", "", "", "", commands);
-                } else if (i < 48) {
-                    epgitem->addEPGItem(QString::number(i), ((i - hnull) * 360) + 170, 0, 360, 40, "epg", "#FF0000",
-                                        "#FFFFFF",
-                                        QString::number((i - 24)) + " Uhr  " + QString::number(dnull + 1) + "." +
-                                            QString::number(mnull) + "." + QString::number(ynull),
-                                        "", "", "", "", "", commands);
-                } else if (i < 72) {
-                    epgitem->addEPGItem(QString::number(i), ((i - hnull) * 360) + 170, 0, 360, 40, "epg", "#FF0000",
-                                        "#FFFFFF",
-                                        QString::number((i - 48)) + " Uhr  " + QString::number(dnull + 2) + "." +
-                                            QString::number(mnull) + "." + QString::number(ynull),
-                                        "", "", "", "", "", commands);
-                } else {
-                    epgitem->addEPGItem(QString::number(i), ((i - hnull) * 360) + 170, 0, 360, 40, "epg", "#FF0000",
-                                        "#FFFFFF",
-                                        QString::number((i - 72)) + " Uhr  " + QString::number(dnull + 3) + "." +
-                                            QString::number(mnull) + "." + QString::number(ynull),
-                                        "", "", "", "", "", commands);
-                }
-                QCoreApplication::instance()->processEvents();
-            }
-
-            int     i = 1;
-            QString channelname = "a";
-            qCDebug(m_logCategory) << "1 for end";
-            qCDebug(m_logCategory) << "2 for start";
-            for (int const& channel : m_epgChannelList) {
-                /*for (int j = 0; m_KodiTVChannelList.count() > j; j++) {
-                    if (m_KodiTVChannelList[j].toMap().value("channelnumber").toInt() == channel) {
-                        channelname = m_KodiTVChannelList[j].toMap().value("label").toString();
-                        break;
-                    }
-                }*/
-                epgitem->addEPGItem(QString::number(i), 0, i, 170, 40, "epg", "#0000FF", "#FFFFFF",
-                                    m_KodiTVChannelList[channel - 1].toMap().value("label").toString(), "", "", "", "",
-                                    "", commands);
-                i++;
-                QCoreApplication::instance()->processEvents();
-            }
-            qCDebug(m_logCategory) << "2 for end";
-            i = 0;
-            qCDebug(m_logCategory) << "3 for start";
-            for (auto const& ob : m_currentEPG) {
-                QString channelUuid = ob.toMap().value("channelUuid").toString();
-                // QString channelUuid = m_currentEPG.value(i).toMap().value("channelUuid").toString();
-                if (m_epgChannelList.contains(m_mapTVHeadendUUIDToKodiChannelNumber.value(channelUuid))) {
-                    timestamp.setTime_t(m_currentEPG.value(i).toMap().value("start").toInt());
-                    int column = m_mapTVHeadendUUIDToKodiChannelNumber.value(channelUuid);
-
-                    if (column != 0) {
-                        int h = (timestamp.date().day() - dnull) * 1440 + (timestamp.time().hour() - hnull) * 60 +
-                                timestamp.time().minute();
-                         qCDebug(m_logCategory) << "xcoor2" << h;
-                         int width =
-                             ((ob.toMap().value("stop").toInt() - ob.toMap().value("start").toInt()) / 60) * 6;
-                         if (h <0) {
-                            width = width+h;
-                             h =0;
-
-                         }
-
-                        if (((h*6)+width) > 15000) {
-                            //break;
-                        } else {
-
-
-                            epgitem->addEPGItem(QString::number(i), (h * 6) + 170, column, width, 40, "epg", "#FFFF00",
-                                                "#FFFFFF", ob.toMap().value("title").toString(), "", "", "", "", "",
-                                                commands);
-                        }
-                    }
-                    QCoreApplication::instance()->processEvents();
-                }
-                i++;
-            }
-            qCDebug(m_logCategory) << "3 for end";
-            MediaPlayerInterface* me = static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
-            me->setBrowseModel(epgitem);
+            m_epgGridOrigin = QDateTime(current.date(), QTime(current.time().hour(), 0)).toTime_t() - 3600;
+            // the events up to the end of the time axis are loaded beyond the regular window
+            extendEPGWindow(EpgGridLayout(m_epgGridOrigin, KODI_EPG_GRID_WIDTH).end());
+            showEpgGrid();
             //epgitem->update();
         /*    contextshowepg->deleteLater();
         });
@@ -1957,18 +2017,41 @@ void Kodi::showepg() {
         " \"id\":\"epg\"}");*/
 }
 
-void Kodi::showepg(int channel) {
-    QObject* contextshowepg = new QObject(context_kodi);
+void Kodi::showEpgGrid() {
+    EpgGridSnapshot snapshot = {m_currentEPG, m_KodiTVChannels, m_strings,
+                                EpgGridLayout(m_epgGridOrigin, KODI_EPG_GRID_WIDTH), m_epgChannelList};
+    // the grid is built on a worker from the copies and installed in one step, replies and timers are handled in the
+    // meantime without seeing a half built model
+    int                              generation = ++m_browseGeneration;
+    QFutureWatcher<BrowseEPGModel*>* watcher = new QFutureWatcher<BrowseEPGModel*>(context_kodi);
+    QObject::connect(watcher, &QFutureWatcherBase::finished, context_kodi, [=]() {
+        watcher->deleteLater();
+        // a newer browse request replaced this one while it was built
+        if (generation != m_browseGeneration) {
+            watcher->result()->deleteLater();
+            return;
+        }
+        m_epgGridGeneration = generation;
+        installEpgModel(watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run(buildEpgGridModel, snapshot, thread()));
+}
+
+void Kodi::showepg(int eventId) {
     /*QObject::connect(
         context_kodi, &Kodi::requestReadygetEPG, contextshowepg, [=](const QJsonDocument& resultJSONDocument) {*/
-            EntityInterface* entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
-            QDateTime        timestamp;
+            QDateTime timestamp;
 
+            // the item id handed out by showepg() is the TVHeadend event id, the event may have been evicted since
+            int channel = m_currentEPG.byEventId(eventId);
+            if (channel < 0) {
+                return;
+            }
             QString     channelId = "2";
-            QVariantMap channelEpg = m_currentEPG.value(channel).toMap();
+            int         epgChannel = m_currentEPG.channel(channel);
             QUrl        imageUrl(m_tvheadendJSONUrl);
             if (!imageUrl.isEmpty()) {
-                imageUrl.setPath("/" + channelEpg.value("channelIcon").toString());
+                imageUrl.setPath("/" + m_currentEPG.channelIcon(epgChannel));
             }
 
             QString     thumbnail = "";
@@ -1977,14 +2060,14 @@ void Kodi::showepg(int channel) {
             QStringList commands = {};
             // 60minuten = 360px; 1min = 6px
 
-            epgitem->reset();
-            epgitem->~BrowseEPGModel();
-            epgitem = new BrowseEPGModel(
-                QString::number(
-                    m_mapTVHeadendUUIDToKodiChannelNumber.value(channelEpg.value("channelUUID").toString())),
-                0, 0, 0, 0, "epg", "#FFFF00", "#FFFFFF", channelEpg.value("title").toString(),
-                channelEpg.value("subtitle").toString(), channelEpg.value("description").toString(), "starttime",
-                "endtime", imageUrl.url(), commands);
+            // a grid or channel list still being built must not replace the detail
+            m_browseGeneration++;
+            int tvChannel = m_KodiTVChannels.byTVHeadendUuid(m_currentEPG.channelUuidHandle(epgChannel));
+            int kodiChannel = tvChannel >= 0 ? m_KodiTVChannels.at(tvChannel).channelNumber : 0;
+            installEpgModel(new BrowseEPGModel(QString::number(kodiChannel), 0, 0, 0, 0, "epg", "#FFFF00", "#FFFFFF",
+                                               m_currentEPG.title(channel), m_currentEPG.subtitle(channel),
+                                               m_currentEPG.description(channel), "starttime", "endtime",
+                                               imageUrl.url(), commands));
             // epgitem->addEPGItem(QString::number(i), (h*6), column, width, 40, "epg", "#FFFF00",
             //     m_currentEPG.value(i).toMap().value("title").toString(), "", "", "", "", "", commands);
             /*QDateTime current = QDateTime::currentDateTime();
@@ -2013,8 +2096,6 @@ void Kodi::showepg(int channel) {
             m_currentEPG.value(i).toMap().value("title").toString(), "", "", "", "", "", commands);
                 }
             }*/
-            MediaPlayerInterface* me = static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
-            me->setBrowseModel(epgitem);
             //epgitem->update();
         /*    contextshowepg->deleteLater();
         });*/
@@ -2028,126 +2109,231 @@ void Kodi::showepg(int channel) {
         " \"id\":\"epg\"}");*/
 }
 
-QString Kodi::fixUrl(QString url) {
-    if (url.contains("127.0.0.1")) {
-        url = url.replace("127.0.0.1", m_tvheadendJSONUrl.host());
+void Kodi::getTVChannelLogos() {
+    // the logos are fetched in the background so the channel list can be shown from disk
+    QStringList urls;
+    for (int channel = 0; channel < m_KodiTVChannels.count(); channel++) {
+        urls.append(m_KodiTVChannels.image(channel));
     }
-    if (url.endsWith('/')) {
-        url = url.chopped(1);
+    for (int channel = 0; channel < m_KodiRadioChannels.count(); channel++) {
+        urls.append(m_KodiRadioChannels.image(channel));
     }
-    return url;
+    m_logoCache->prefetch(urls);
 }
 
-bool Kodi::read(QMap<QString, int>* map) {
-    QString path = "/opt/yio/userdata/kodi/";
-    QString filename = "data1.dat";
-    QFile   myFile(path + filename);
-    // QMap<int, QString> map;
-    QDataStream in(&myFile);
-    in.setVersion(QDataStream::Qt_5_8);
-
-    if (!myFile.open(QIODevice::ReadOnly)) {
-        qCDebug(m_logCategory) << "Could not read the file:" << filename << "Error string:" << myFile.errorString();
-        qCDebug(m_logCategory) << "Read status" << in.status();
-        return false;
+void Kodi::applyTVHeadendUUIDs() {
+    // the mapping is kept by channel number, the caches also index the channels by the pool handle of their UUID
+    for (auto it = m_mapKodiChannelNumberToTVHeadendUUID.constBegin();
+         it != m_mapKodiChannelNumberToTVHeadendUUID.constEnd(); ++it) {
+        int channel = m_KodiTVChannels.byChannelNumber(it.key());
+        if (channel >= 0) {
+            m_KodiTVChannels.setTVHeadendUuid(channel, it.value());
+        }
     }
-
-    in >> *map;
-    qCDebug(m_logCategory) << "Read status" << in.status();
-    return true;
+    for (auto it = m_mapKodiChannelNumberToRadioHeadendUUID.constBegin();
+         it != m_mapKodiChannelNumberToRadioHeadendUUID.constEnd(); ++it) {
+        int channel = m_KodiRadioChannels.byChannelNumber(it.key());
+        if (channel >= 0) {
+            m_KodiRadioChannels.setTVHeadendUuid(channel, it.value());
+        }
+    }
+    // the EPG can only be loaded for mapped channels
+    scheduleEPGLoad();
 }
 
-bool Kodi::write(QMap<QString, int> map) {
-    QString path = "/opt/yio/userdata/kodi/";
-    QString filename = "data1.dat";
-    QFile   myFile(filename);
-    QDir    dir(path);
+void Kodi::dropChannelMappings() {
+    qCWarning(m_logCategory) << "TVHeadend has no EPG for the mapped channels, the channel mappings are rebuilt";
+    QFile::remove(channelMappingFile("tv"));
+    QFile::remove(channelMappingFile("radio"));
+    m_mapKodiChannelNumberToTVHeadendUUID.clear();
+    m_mapTVHeadendUUIDToKodiChannelNumber.clear();
+    m_mapKodiChannelNumberToRadioHeadendUUID.clear();
+    m_mapRadioHeadendUUIDToKodiChannelNumber.clear();
+    m_KodiTVChannels.clearTVHeadendUuids();
+    m_KodiRadioChannels.clearTVHeadendUuids();
+    scheduleEPGLoad();
+    getKodiChannelNumberToTVHeadendUUIDMapping();
+    getKodiChannelNumberToRadioHeadendUUIDMapping();
+}
 
-    if (!dir.exists()) {
-        qCDebug(m_logCategory) << "Creating " << path << "directory";
+void Kodi::installEpgModel(BrowseEPGModel* model) {
+    BrowseEPGModel* retired = epgitem;
+    epgitem = model;
+    EntityInterface* entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
+    if (entity) {
+        MediaPlayerInterface* me = static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
+        me->setBrowseModel(epgitem);
+    }
+    // the view has switched to the new model, the old one goes once pending events for it are delivered
+    retired->deleteLater();
+}
 
-        if (dir.mkpath(path)) {
-            qCDebug(m_logCategory) << path << "successfully created";
-        } else {
-            qCDebug(m_logCategory) << "error during creation of " << path;
-            return false;
+void Kodi::installChannelModel(BrowseChannelModel* model) {
+    BrowseChannelModel* retired = tvchannel;
+    tvchannel = model;
+    // the logos of a shown list are in use, the worker built model could not record that itself
+    if (m_channelModelSource) {
+        QStringList logos;
+        for (int channel = 0; channel < m_channelModelSource->count(); channel++) {
+            logos.append(m_channelModelSource->image(channel));
         }
-    } else {
-        qCDebug(m_logCategory) << path << " already exists";
+        m_logoCache->touch(logos);
     }
+    EntityInterface* entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
+    if (entity) {
+        MediaPlayerInterface* me = static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
+        me->setBrowseModel(tvchannel);
+    }
+    // a model kept up to date is installed again
+    if (retired != model) {
+        retired->deleteLater();
+    }
+}
 
-    if (!myFile.open(QIODevice::WriteOnly)) {
-        qCDebug(m_logCategory) << "Could not write to file:" << filename << "Error string:" << myFile.errorString();
-        return false;
+QString Kodi::integrationFile(const QString& name) {
+    // one file per integration in the user data directory, the id may contain characters not allowed in file names
+    QString id = integrationId();
+    for (QChar& c : id) {
+        if (!c.isLetterOrNumber() && c != '_' && c != '-' && c != '.') {
+            c = '_';
+        }
     }
-    QDataStream out(&myFile);
-    out.setVersion(QDataStream::Qt_5_8);
-    out << map;
-    qCDebug(m_logCategory) << "Write status" << out.status();
-    return true;
+    return KODI_USERDATA_PATH + name + "-" + id + ".dat";
 }
 
-bool Kodi::read(QMap<int, QString>* map) {
-    QString path = "/opt/yio/userdata/kodi/";
-    QString filename = "data.dat";
-    QFile   myFile(path + filename);
+QString Kodi::channelMappingFile(const QString& backend) { return integrationFile("mapping-" + backend); }
 
-    QDataStream in(&myFile);
-    in.setVersion(QDataStream::Qt_5_8);
+QString Kodi::tvheadendAddress() const {
+    return m_tvheadendJSONUrl.host() + ":" + QString::number(m_tvheadendJSONUrl.port());
+}
+
+bool Kodi::readChannelMapping(const QString& backend, const ChannelCache& channels, QMap<int, QString>* numberToUuid,
+                              QMap<QString, int>* uuidToNumber) {
+    QString filename = channelMappingFile(backend);
+    QFile   myFile(filename);
 
     if (!myFile.open(QIODevice::ReadOnly)) {
         qCDebug(m_logCategory) << "Could not read the file:" << filename << "Error string:" << myFile.errorString();
-        qCDebug(m_logCategory) << "Read status" << in.status();
+        return false;
+    }
+    QDataStream in(&myFile);
+    in.setVersion(QDataStream::Qt_5_8);
+    quint32            magic = 0;
+    quint32            version = 0;
+    QString            tvheadend;
+    QByteArray         fingerprint;
+    QMap<int, QString> map;
+    in >> magic >> version;
+    if (magic != KODI_MAPPING_MAGIC || version != KODI_MAPPING_VERSION) {
+        qCDebug(m_logCategory) << "Channel mapping" << filename << "is outdated";
+        return false;
+    }
+    in >> tvheadend >> fingerprint >> map;
+    if (in.status() != QDataStream::Ok) {
+        qCDebug(m_logCategory) << "Channel mapping" << filename << "is damaged";
+        return false;
+    }
+    // built for another TVHeadend or another channel lineup
+    if (tvheadend != tvheadendAddress() || fingerprint != channels.fingerprint()) {
+        qCDebug(m_logCategory) << "Channel mapping" << filename << "does not match the channels";
         return false;
     }
 
-    in >> *map;
-    qCDebug(m_logCategory) << "Read status" << in.status();
+    *numberToUuid = map;
+    uuidToNumber->clear();
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        uuidToNumber->insert(it.value(), it.key());
+    }
     return true;
 }
 
-bool Kodi::write(QMap<int, QString> map) {
-    QString path = "/opt/yio/userdata/kodi/";
-    QString filename = "data.dat";
-    QFile   myFile(filename);
-    QDir    dir(path);
-
-    if (!dir.exists()) {
-        qCDebug(m_logCategory) << "Creating " << path << "directory";
+bool Kodi::writeChannelMapping(const QString& backend, const ChannelCache& channels,
+                               const QMap<int, QString>& numberToUuid) {
+    return saveUserData(channelMappingFile(backend), [&](QDataStream* out) {
+        *out << static_cast<quint32>(KODI_MAPPING_MAGIC) << static_cast<quint32>(KODI_MAPPING_VERSION);
+        *out << tvheadendAddress() << channels.fingerprint() << numberToUuid;
+    });
+}
 
-        if (dir.mkpath(path)) {
-            qCDebug(m_logCategory) << path << "successfully created";
-        } else {
-            qCDebug(m_logCategory) << "error during creation of " << path;
-            return false;
-        }
-    } else {
-        qCDebug(m_logCategory) << path << " already exists";
+bool Kodi::saveUserData(const QString& filename, const std::function<void(QDataStream*)>& write) {
+    QDir dir(KODI_USERDATA_PATH);
+    if (!dir.exists() && !dir.mkpath(KODI_USERDATA_PATH)) {
+        qCDebug(m_logCategory) << "error during creation of " << KODI_USERDATA_PATH;
+        return false;
     }
-
+    // the old file is only replaced by a completely written one
+    QSaveFile myFile(filename);
     if (!myFile.open(QIODevice::WriteOnly)) {
         qCDebug(m_logCategory) << "Could not write to file:" << filename << "Error string:" << myFile.errorString();
         return false;
     }
-
     QDataStream out(&myFile);
     out.setVersion(QDataStream::Qt_5_8);
-    out << map;
-    qCDebug(m_logCategory) << "Write status" << out.status();
+    write(&out);
+    if (out.status() != QDataStream::Ok || !myFile.commit()) {
+        qCDebug(m_logCategory) << "Could not write to file:" << filename << "Error string:" << myFile.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool Kodi::readEPG() {
+    QString filename = integrationFile("epg");
+    QFile   myFile(filename);
+
+    if (!myFile.open(QIODevice::ReadOnly)) {
+        qCDebug(m_logCategory) << "Could not read the file:" << filename << "Error string:" << myFile.errorString();
+        return false;
+    }
+    // the snapshot is read straight from the mapped file, the store copies what it keeps
+    uchar* data = myFile.map(0, myFile.size());
+    if (!data) {
+        qCDebug(m_logCategory) << "Could not map the file:" << filename << "Error string:" << myFile.errorString();
+        return false;
+    }
+    QByteArray  bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(data), static_cast<int>(myFile.size()));
+    QDataStream in(bytes);
+    in.setVersion(QDataStream::Qt_5_8);
+    QString tvheadend;
+    quint32 loadedUntil = 0;
+    in >> tvheadend;
+    // the guide of another TVHeadend is not restored
+    bool ok = tvheadend == tvheadendAddress() && m_currentEPG.read(&in);
+    in >> loadedUntil;
+    myFile.unmap(data);
+    if (!ok || in.status() != QDataStream::Ok) {
+        qCDebug(m_logCategory) << "EPG snapshot" << filename << "is outdated, damaged or of another TVHeadend";
+        m_currentEPG.clear();
+        return false;
+    }
+
+    uint now = QDateTime::currentDateTime().toTime_t();
+    m_currentEPG.evict(now - static_cast<uint>(m_epgRetentionInHours) * 3600);
+    if (loadedUntil > now) {
+        m_epgLoadedUntil = loadedUntil;
+        m_epgRestoredUntil = loadedUntil;
+    }
+    qCDebug(m_logCategory) << "EPG snapshot restored with" << m_currentEPG.count() << "events";
     return true;
 }
 
+bool Kodi::writeEPG() {
+    return saveUserData(integrationFile("epg"), [&](QDataStream* out) {
+        *out << tvheadendAddress();
+        m_currentEPG.write(out);
+        *out << static_cast<quint32>(m_epgLoadedUntil);
+    });
+}
+
 void Kodi::kodiconnectioncheck(const QJsonDocument& resultJSONDocument) {
     if (resultJSONDocument.object().contains("result")) {
         if (resultJSONDocument.object().value("result") == "pong") {
             if (!m_flagKodiOnline) {
                 m_flagKodiOnline = true;
-                m_pollingTimer->setInterval(5000);
-                QObject::connect(m_pollingTimer, &QTimer::timeout, context_kodi, &Kodi::onPollingTimerTimeout);
-
                 m_progressBarTimer->setInterval(1000);
                 QObject::connect(m_progressBarTimer, &QTimer::timeout, context_kodi, &Kodi::onProgressBarTimerTimeout);
                 m_tcpSocketKodiEventServer = new QTcpSocket(context_kodi);
+                m_eventServerFramer.clear();
                 m_tcpSocketKodiEventServer->connectToHost(m_kodiEventServerUrl.host(), m_kodiEventServerUrl.port());
                 if (m_tcpSocketKodiEventServer->waitForConnected()) {
                     QObject::connect(m_tcpSocketKodiEventServer, &QTcpSocket::readyRead, context_kodi,
@@ -2155,12 +2341,12 @@ void Kodi::kodiconnectioncheck(const QJsonDocument& resultJSONDocument) {
                     QObject::connect(m_tcpSocketKodiEventServer, &QTcpSocket::disconnected, context_kodi,
                                      &Kodi::clientDisconnected);
                     m_flagKodiEventServerOnline = true;
-                    QObject::connect(context_kodi, &Kodi::requestReadygetCurrentPlayer, context_kodi,
-                                     &Kodi::updateCurrentPlayer);
                 } else {
                     m_flagKodiEventServerOnline = false;
                 }
-                m_pollingTimer->start();
+                updatePollingInterval();
+                m_pollingScheduler->start(m_pollingTaskCurrentPlayer, KODI_POLLING_INTERVAL);
+                m_pollingScheduler->start(m_pollingTaskConnectionCheck, KODI_CONNECTIONCHECK_INTERVAL);
                 getKodiAvailableTVChannelList();
                 getKodiAvailableRadioChannelList();
                 getCurrentPlayer();
@@ -2185,13 +2371,9 @@ void Kodi::kodiconnectioncheck(const QJsonDocument& resultJSONDocument) {
                 qCWarning(m_logCategory) << "Kodi not reachable";
             } else {
                 _networktries++;
-                postRequest(
-                    "{ \"jsonrpc\": \"2.0\","
-                    " \"method\": \"JSONRPC.Ping\", \"params\": {  },"
-                    " \"id\":\"ConnectionCheck\"}");
+                postRequest(KODI_PING, [=](const QJsonDocument& doc) { kodiconnectioncheck(doc); });
             }
         }
-    } else if (m_kodireply->error() == QNetworkReply::NetworkError::OperationCanceledError) {
     } else {
         if (_networktries == MAX_CONNECTIONTRY) {
             _networktries = 0;
@@ -2203,15 +2385,11 @@ void Kodi::kodiconnectioncheck(const QJsonDocument& resultJSONDocument) {
                     i->connect();
                 },
                 context_kodi);
-            qCDebug(m_logCategory) << m_kodireply->error() << m_kodireply->errorString();
             disconnect();
             qCWarning(m_logCategory) << "Kodi not reachable";
         } else {
             _networktries++;
-            postRequest(
-                "{ \"jsonrpc\": \"2.0\","
-                " \"method\": \"JSONRPC.Ping\", \"params\": {  },"
-                " \"id\":\"ConnectionCheck\"}");
+            postRequest(KODI_PING, [=](const QJsonDocument& doc) { kodiconnectioncheck(doc); });
         }
     }
 }
@@ -2221,11 +2399,9 @@ void Kodi::Tvheadendconnectioncheck(const QJsonDocument& resultJSONDocument) {
         // qCDebug(m_logCategory) << "tvheadend configured";
         m_flagTVHeadendOnline = true;
         // getTVEPGfromTVHeadend();
-        if (!m_pollingEPGLoadTimer->isActive()) {
-            m_pollingEPGLoadTimer->setInterval(10000);
-            QObject::connect(m_pollingEPGLoadTimer, &QTimer::timeout, context_kodi,
-                             &Kodi::onPollingEPGLoadTimerTimeout);
-            m_pollingEPGLoadTimer->start();
+        // a loader which sleeps until the programme expires or retries failed channels is left alone
+        if (!m_pollingScheduler->isActive(m_pollingTaskEPGLoad)) {
+            scheduleEPGLoad();
         }
     } else {
         m_flagTVHeadendOnline = false;
@@ -2235,37 +2411,24 @@ void Kodi::Tvheadendconnectioncheck(const QJsonDocument& resultJSONDocument) {
 }
 
 void Kodi::KodiApplicationProperties() {
-    QObject* contextKodiApplicationProperties = new QObject(context_kodi);
-
-    QObject::connect(context_kodi, &Kodi::requestReadyKodiApplicationProperties, contextKodiApplicationProperties,
-                     [=](const QJsonDocument& resultJSONDocument) {
-                         EntityInterface* entity =
-                             static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
-                         if (resultJSONDocument.object().value("id") == "Application.GetProperties") {
-                             // QString strJson(resultJSONDocument.toJson(QJsonDocument::Compact));
-                             // qCDebug(m_logCategory) << strJson;
-                             entity->updateAttrByIndex(MediaPlayerDef::VOLUME,
-                                                       resultJSONDocument.object().value("result")["volume"].toInt());
-                         }
-                         contextKodiApplicationProperties->deleteLater();
-                     });
-    postRequest(
-        "{ \"jsonrpc\": \"2.0\","
-        " \"method\": \"Application.GetProperties\", \"params\" : { \"properties\" : [ \"volume\", \"muted\" ] },"
-        " \"id\":\"Application.GetProperties\"}");
+    postRequest(KODI_GET_APPLICATION_PROPERTIES, [=](const QJsonDocument& resultJSONDocument) {
+        EntityInterface* entity = static_cast<EntityInterface*>(m_entities->getEntityInterface(m_entityId));
+        if (resultJSONDocument.object().contains("result")) {
+            // QString strJson(resultJSONDocument.toJson(QJsonDocument::Compact));
+            // qCDebug(m_logCategory) << strJson;
+            entity->updateAttrByIndex(MediaPlayerDef::VOLUME,
+                                      resultJSONDocument.object().value("result")["volume"].toInt());
+        }
+    });
 }
 
 
 
 void Kodi::getUserPlaylists() {
 
-    QObject* contextgetUserPlaylists = new QObject(context_kodi);
-
-    QObject::connect(context_kodi, &Kodi::requestReadygetUserPlaylists, contextgetUserPlaylists,
-                     [=](const QJsonDocument& resultJSONDocument) {
+    postRequest(KODI_GET_PLAYLIST_ITEMS,
+                [=](const QJsonDocument& resultJSONDocument) {
             qCDebug(m_logCategory) << "GET USERS PLAYLIST";
-            QString strJson(resultJSONDocument.toJson(QJsonDocument::Compact));
-            qCDebug(m_logCategory) <<strJson;
 
             QString     id = "";
             QString     title = "";
@@ -2305,10 +2468,7 @@ void Kodi::getUserPlaylists() {
                 MediaPlayerInterface* me = static_cast<MediaPlayerInterface*>(entity->getSpecificInterface());
                 me->setBrowseModel(album);
             }*/
-
-        contextgetUserPlaylists->deleteLater();
     });
-   postRequest("{\"jsonrpc\": \"2.0\", \"method\": \"Playlist.GetItems\", \"params\": { \"properties\": [\"title\", \"album\", \"artist\", \"duration\"], \"playlistid\": 0 }, \"id\": \"Playlist.GetItems\"}");
     // postRequest("{\"jsonrpc\": \"2.0\", \"id\": \"Playlist.GetItems\", \"method\": \"Playlist.GetPlaylists\"}");
     /*postRequest(
                 "{\"jsonrpc\": \"2.0\", \"method\": \"Playlist.GetItems\", \"params\": { \"properties\": [\"title\", \"album\", \"artist\", \"duration\"], \"playlistid\": 0 }, \"id\": \"Playlist.GetItems\"}"
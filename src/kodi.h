@@ -23,7 +23,11 @@
 #pragma once
 #include <QAuthenticator>
 #include <QByteArray>
+#include <QDataStream>
 #include <QDebug>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QNetworkAccessManager>
 #include <QNetworkConfigurationManager>
 #include <QNetworkCookieJar>
@@ -37,6 +41,8 @@
 #include <QUrl>
 #include <QVariantMap>
 
+#include <functional>
+
 #include "yio-interface/entities/mediaplayerinterface.h"
 #include "yio-model/mediaplayer/channelmodel_mediaplayer.h"
 #include "yio-model/mediaplayer/epgmodel_mediaplayer.h"
@@ -44,6 +50,16 @@
 #include "yio-plugin/integration.h"
 #include "yio-plugin/plugin.h"
 
+#include "channelcache.h"
+#include "epggridlayout.h"
+#include "epggridreader.h"
+#include "epgstore.h"
+#include "jsonrpcrequest.h"
+#include "jsonstreamframer.h"
+#include "logocache.h"
+#include "pollingscheduler.h"
+#include "requestqueue.h"
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// Kodi FACTORY
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -69,6 +85,30 @@ class KodiPlugin : public Plugin {
 //// Kodi CLASS
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #define MAX_CONNECTIONTRY 4
+// polling intervals in ms, now playing is polled less often while idle or while the event server socket is alive
+#define KODI_POLLING_INTERVAL 5000
+#define KODI_POLLING_INTERVAL_IDLE 15000
+#define KODI_POLLING_INTERVAL_EVENTSERVER 30000
+#define KODI_POLLING_MAX_BACKOFF 60000
+#define KODI_CONNECTIONCHECK_INTERVAL 60000
+#define KODI_EPG_LOAD_INTERVAL 10000
+#define KODI_EPG_CHANNEL_EVENTS 48
+#define KODI_EPG_RETENTION 2
+#define KODI_EPG_LOOKAHEAD 12
+#define KODI_EPG_GRID_WIDTH 15000
+// concurrent HTTP requests per host, interactive requests are not limited
+#define KODI_MAX_CONNECTIONS 2
+#define TVHEADEND_MAX_CONNECTIONS 2
+// requests sent over the event server socket are completed without reply after this time
+#define KODI_REQUEST_TIMEOUT 10000
+// directory of the files the integration keeps between runs
+#define KODI_USERDATA_PATH "/opt/yio/userdata/kodi/"
+// channel logos kept on disk and downloaded at a time
+#define KODI_LOGO_CACHE_SIZE (16 * 1024 * 1024)
+#define KODI_LOGO_DOWNLOADS 2
+// header of the stored TVHeadend channel mappings
+#define KODI_MAPPING_MAGIC 0x594d4150
+#define KODI_MAPPING_VERSION 1
 
 class Kodi : public Integration {
     Q_OBJECT
@@ -93,38 +133,9 @@ class Kodi : public Integration {
 
  signals:
     // void requestReady(const QVariantMap& obj, const QString& url);
-    void requestReadygetKodiAvailableTVChannelList(const QJsonDocument& object);
-    void requestReadyKodiConnectionCheck(const QJsonDocument& object);
     void requestReadyTvheadendConnectionCheck(const QJsonDocument& object);
     void requestReadygetKodiChannelNumberToTVHeadendUUIDMapping(const QJsonDocument& object);
-    void requestReadygetTVEPGfromTVHeadend(const QJsonDocument& doc);
-    void requestReadygetSingleTVChannelList(const QJsonDocument& doc);
-    void requestReadygetCompleteTVChannelList(const QJsonDocument& doc);
-    void requestReadygetKodiAvailableRadioChannelList(const QJsonDocument& doc);
     void requestReadygetKodiChannelNumberToRadioHeadendUUIDMapping(const QJsonDocument& doc);
-    void requestReadygetCompleteRadioChannelList(const QJsonDocument& doc);
-
-    // void requestReadyt(const QVariantMap& obj, const QString& url);
-    void requestReadygetCurrentPlayer(const QJsonDocument& doc);
-    void requestReadyCommandPlay(const QJsonDocument& doc);
-    void requestReadyCommandPause(const QJsonDocument& doc);
-    void requestReadyCommandStop(const QJsonDocument& doc);
-    void requestReadyCommandNext(const QJsonDocument& doc);
-    void requestReadyCommandPrevious(const QJsonDocument& doc);
-    void requestReadyCommandUp(const QJsonDocument& doc);
-    void requestReadyCommandDown(const QJsonDocument& doc);
-    void requestReadyCommandLeft(const QJsonDocument& doc);
-    void requestReadyCommandRight(const QJsonDocument& doc);
-    void requestReadyCommandOk(const QJsonDocument& doc);
-    void requestReadyCommandBack(const QJsonDocument& doc);
-    void requestReadyCommandChannelUp(const QJsonDocument& doc);
-    void requestReadyCommandChannelDown(const QJsonDocument& doc);
-    void requestReadyCommandMute(const QJsonDocument& doc);
-    void requestReadyKodiApplicationProperties(const QJsonDocument& doc);
-    void requestReadyCommandVolume(const QJsonDocument& doc);
-    void requestReadygetEPG(const QJsonDocument& doc);
-    void requestReadyCommandMenu(const QJsonDocument& doc);
-    void requestReadygetUserPlaylists(const QJsonDocument& doc);
 
     // void requestReadyoiu(const QVariantMap& obj, const QString& url);
     // void requestReadyParser(const QJsonDocument& doc, const QString& url);
@@ -134,8 +145,6 @@ class Kodi : public Integration {
     // void closed();
 
  private slots:
-    void onPollingTimerTimeout();
-    void onPollingEPGLoadTimerTimeout();
     void onProgressBarTimerTimeout();
     // void processMessage(QString message);
     // void onPollingTimer();
@@ -143,17 +152,53 @@ class Kodi : public Integration {
     void readTcpData();
     void clientDisconnected();
     void checkTCPSocket();
-    void updateCurrentPlayer(const QJsonDocument& doc);
 
  private:
-    QString fixUrl(QString url);
-    bool    read(QMap<int, QString>* map);
-    bool    write(QMap<int, QString> map);
-    bool    read(QMap<QString, int>* map);
-    bool    write(QMap<QString, int> map);
+    // Kodi JSON-RPC requests are correlated with their replies by a numeric id
+    typedef std::function<void(const QJsonDocument&)> KodiReplyHandler;
+    struct KodiRequest {
+        JsonRpcRequest   request;
+        KodiReplyHandler handler;
+    };
+    struct KodiPendingRequest {
+        QByteArray       method;
+        KodiReplyHandler handler;
+        bool             eventServer;
+    };
+    // latest value of a command which is sent at most once at a time, e.g. while the volume slider is dragged
+    struct KodiCoalescedRequest {
+        JsonRpcRequest   request;
+        KodiReplyHandler handler;
+        bool             inFlight = false;
+        bool             pending = false;
+    };
+    // called once a TVHeadend EPG grid reply was read with the number of events in it, valid is false for failed and
+    // unreadable replies
+    typedef std::function<void(bool valid, int events)> EpgReplyHandler;
+
+ private:
+    void    installEpgModel(BrowseEPGModel* model);
+    void    installChannelModel(BrowseChannelModel* model);
+    void    applyTVHeadendUUIDs();
+    void    dropChannelMappings();
+    QString integrationFile(const QString& name);
+    QString channelMappingFile(const QString& backend);
+    QString tvheadendAddress() const;
+    bool    readChannelMapping(const QString& backend, const ChannelCache& channels, QMap<int, QString>* numberToUuid,
+                               QMap<QString, int>* uuidToNumber);
+    bool    writeChannelMapping(const QString& backend, const ChannelCache& channels,
+                                const QMap<int, QString>& numberToUuid);
+    bool    saveUserData(const QString& filename, const std::function<void(QDataStream*)>& write);
+    bool    readEPG();
+    bool    writeEPG();
     void    kodiconnectioncheck(const QJsonDocument& object);
     void    Tvheadendconnectioncheck(const QJsonDocument& object);
     void    KodiApplicationProperties();
+    void    handleKodiNotification(const QString& method, const QJsonObject& data);
+    void    onPollingTimerTimeout();
+    void    onPollingConnectionCheckTimeout();
+    void    onPollingEPGLoadTimerTimeout();
+    void    updatePollingInterval();
 
  private:
     bool m_flagTVHeadendConfigured = false;
@@ -164,11 +209,12 @@ class Kodi : public Integration {
     bool    m_startup = true;
     QString m_entityId;
     // bool              m_flage = false;
-    int               m_timer = 0;
     QNetworkInterface m_iface;
     QTimer*           m_Timer;
-    QTimer*           m_pollingTimer;
-    QTimer*           m_pollingEPGLoadTimer;
+    PollingScheduler* m_pollingScheduler;
+    int               m_pollingTaskCurrentPlayer = -1;
+    int               m_pollingTaskConnectionCheck = -1;
+    int               m_pollingTaskEPGLoad = -1;
     QTimer*           m_progressBarTimer;
     int               m_progressBarPosition = 0;
     bool              m_firstrun = true;
@@ -177,8 +223,6 @@ class Kodi : public Integration {
     QMap<QString, int>        m_mapTVHeadendUUIDToKodiChannelNumber;
     QMap<int, QString>        m_mapKodiChannelNumberToRadioHeadendUUID;
     QMap<QString, int>        m_mapRadioHeadendUUIDToKodiChannelNumber;
-    QList<QVariant>           m_KodiTVChannelList;
-    QList<QVariant>           m_KodiRadioChannelList;
     KodiGetCurrentPlayerState m_KodiGetCurrentPlayerState = KodiGetCurrentPlayerState::GetActivePlayers;
     KodiGetCurrentPlayerState m_KodiNextPlayerState = KodiGetCurrentPlayerState::GetActivePlayers;
     QString                   m_KodiCurrentPlayerThumbnail = "";
@@ -186,7 +230,24 @@ class Kodi : public Integration {
     int                           m_globalKodiRequestID = 12345;
     int                           m_tvProgrammExpireTimeInHours = 2;
     int                           m_EPGExpirationTimestamp = 0;
-    QList<QVariant>               m_currentEPG;
+    int                           m_epgRetentionInHours = KODI_EPG_RETENTION;
+    int                           m_tvheadendMaxConnections = TVHEADEND_MAX_CONNECTIONS;
+    int                           m_epgLookAheadInHours = KODI_EPG_LOOKAHEAD;
+    uint                          m_epgLoadedUntil = 0;
+    uint                          m_epgRestoredUntil = 0;
+    int                           m_epgRequestsPending = 0;
+    int                           m_epgGeneration = 0;
+    int                           m_epgEventsLoaded = 0;
+    int                           m_epgExtensionsPending = 0;
+    int                           m_epgExtensionGeneration = 0;
+    bool                          m_epgExtensionFailed = false;
+    uint                          m_epgGridOrigin = 0;
+    // one copy of every UUID, title and label text, the EPG and the channel caches hold handles into it
+    StringPool                    m_strings;
+    EpgStore                      m_currentEPG = EpgStore(&m_strings);
+    ChannelCache                  m_KodiTVChannels = ChannelCache(&m_strings);
+    ChannelCache                  m_KodiRadioChannels = ChannelCache(&m_strings);
+    EpgGridReader                 m_epgGridReader;
     QProcess                      m_checkProcessKodiAvailability;
     QProcess                      m_checkProcessTVHeadendAvailability;
     bool                          m_flagKodiOnline = false;
@@ -194,20 +255,38 @@ class Kodi : public Integration {
     QUrl                          m_kodiJSONRPCUrl;
     QUrl                          m_kodiEventServerUrl;
     QUrl                          m_tvheadendJSONUrl;
-    QTcpSocket*                   m_tcpSocketKodiEventServer;
+    QTcpSocket*                   m_tcpSocketKodiEventServer = nullptr;
     bool                          m_flagKodiEventServerOnline = false;
-    int                           m_currentEPGchannelToLoad = 0;
+    JsonStreamFramer              m_eventServerFramer;
+    QList<int>                    m_epgChannelsToLoad;
     Kodi*                         context_kodi;
     QNetworkConfigurationManager* manager;  // = new QNetworkConfigurationManager(this);
     QList<int> m_epgChannelList;  // = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21};
     QNetworkAccessManager* networkManagerTvHeadend;  // = new QNetworkAccessManager(this);
     QNetworkAccessManager* networkManagerKodi;       // = new QNetworkAccessManager(this);
-    QNetworkReply*         m_kodireply;
-    QNetworkReply*         m_tvreply;
+    RequestQueue*          m_tvheadendRequestQueue;
+    RequestQueue*          m_kodiRequestQueue;
+    LogoCache*             m_logoCache;
     BrowseChannelModel* tvchannel =
             new BrowseChannelModel("", "", "", "", "", "", {}, nullptr);
     BrowseEPGModel* epgitem = new BrowseEPGModel("", 0, 0, 0, 0, "", "", "", "", "", "", "", "", "", {}, nullptr);
     int             _networktries = 0;
+    // every browse request counts up, models built on a worker or after a reply are only installed for the latest one
+    int m_browseGeneration = 0;
+    // the browse generation of the grid being shown, rebuilt while it is the latest browse model
+    int m_epgGridGeneration = -1;
+    // the channel list and revision tvchannel was built from
+    const ChannelCache* m_channelModelSource = nullptr;
+    int                 m_channelModelRevision = 0;
+    int                 m_channelModelRows = 0;
+    int                 m_channelModelLogos = 0;
+
+    // requests waiting for their reply, keyed by JSON-RPC id
+    QHash<int, KodiPendingRequest>          m_kodiPendingRequests;
+    // coalesced commands keyed by JSON-RPC method
+    QHash<QByteArray, KodiCoalescedRequest> m_kodiCoalescedRequests;
+    // parameters of the request which is built next
+    JsonRpcParams                           m_kodiParams;
     // bool                   m_flag = false;
     // Kodi API calls
     /*void search(QString query);
@@ -218,20 +297,35 @@ class Kodi : public Integration {
     void getCompleteTVChannelList(QString param);
     // Kodi Connect API calls
     void getCurrentPlayer();
+    void updateCurrentPlayer(const QString& method, const QJsonDocument& doc);
     void getKodiAvailableTVChannelList();
     void getKodiChannelNumberToTVHeadendUUIDMapping();
     void getKodiAvailableRadioChannelList();
     void getKodiChannelNumberToRadioHeadendUUIDMapping();
     // void updateEntity(const QString& entity_id, const QVariantMap& attr);
-    void getTVEPGfromTVHeadend(int KodiChannelNumber);
+    bool getTVEPGfromTVHeadend(int KodiChannelNumber, uint from, uint to, const EpgReplyHandler& handler);
+    void scheduleEPGLoad();
+    void finishEPGLoad(uint until);
+    void extendEPGWindow(uint until);
     void getTVChannelLogos();
     void clearMediaPlayerEntity();
     void showepg();
-    void showepg(int channel);
+    void showepg(int eventId);
+    void showEpgGrid();
     // get and post requests
     void tvheadendGetRequest(const QString& path, const QList<QPair<QString, QString> >& queryItems);
     void getUserPlaylists();
     // void postRequest(const QString& params, const int& id);
-    void postRequest(const QString& jsonstring);
+    void postRequest(const JsonRpcRequest& request, const KodiReplyHandler& handler = nullptr);
+    void postBatchRequest(const QList<KodiRequest>& requests);
+    void postCoalescedRequest(const JsonRpcRequest& request, const KodiReplyHandler& handler);
+    void sendCoalescedRequest(const QByteArray& method);
+    int  registerKodiRequest(const KodiRequest& request, QByteArray* body);
+    void completeKodiRequest(int id, const QJsonDocument& doc);
+    void sendKodiRequest(const QByteArray& body, const QList<int>& ids);
+    void dispatchKodiReply(const QJsonDocument& doc);
+
+    RequestQueue::Priority kodiRequestPriority(const QByteArray& method) const;
+    QNetworkRequest        tvheadendRequest(const QString& path, const QList<QPair<QString, QString> >& queryItems);
     // void postRequestthumb(const QString& url, const QString& method, const QString& jsonstring);
 };
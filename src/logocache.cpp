@@ -0,0 +1,158 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#include "logocache.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QUrl>
+#include <algorithm>
+
+LogoCache::LogoCache(RequestQueue* queue, const QString& directory, qint64 maxBytes, int maxDownloads,
+                     QObject* parent)
+    : QObject(parent), m_queue(queue), m_directory(directory), m_maxBytes(maxBytes), m_maxDownloads(maxDownloads) {
+    QDir().mkpath(m_directory);
+    scan();
+}
+
+QString LogoCache::url(const QString& remoteUrl) {
+    auto it = m_entries.find(fileName(remoteUrl));
+    if (it == m_entries.end()) {
+        return remoteUrl;
+    }
+    it->remoteUrl = remoteUrl;
+    it->used = ++m_useCounter;
+    return m_localUrls[remoteUrl] = QUrl::fromLocalFile(m_directory + it.key()).toString();
+}
+
+void LogoCache::touch(const QStringList& remoteUrls) {
+    for (const QString& remoteUrl : remoteUrls) {
+        if (!m_localUrls.contains(remoteUrl)) {
+            continue;
+        }
+        auto it = m_entries.find(fileName(remoteUrl));
+        if (it != m_entries.end()) {
+            it->used = ++m_useCounter;
+        }
+    }
+}
+
+void LogoCache::prefetch(const QStringList& remoteUrls) {
+    for (const QString& remoteUrl : remoteUrls) {
+        if (remoteUrl.isEmpty() || m_requested.contains(remoteUrl)) {
+            continue;
+        }
+        auto it = m_entries.find(fileName(remoteUrl));
+        if (it != m_entries.end()) {
+            // found on disk by the scan, only the remote URL was unknown
+            if (it->remoteUrl.isEmpty()) {
+                it->remoteUrl = remoteUrl;
+                m_localUrls.insert(remoteUrl, QUrl::fromLocalFile(m_directory + it.key()).toString());
+                m_revision++;
+            }
+            continue;
+        }
+        m_requested.insert(remoteUrl);
+        m_waiting.enqueue(remoteUrl);
+    }
+    downloadNext();
+}
+
+void LogoCache::cancel() {
+    m_waiting.clear();
+    m_requested.clear();
+    m_downloads = 0;
+}
+
+void LogoCache::scan() {
+    QDir          dir(m_directory);
+    QFileInfoList files = dir.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QFileInfo& file : files) {
+        // left over from an interrupted write or not a logo of this cache
+        if (file.size() == 0 || file.fileName().length() != 40) {
+            dir.remove(file.fileName());
+            continue;
+        }
+        m_entries.insert(file.fileName(), {QString(), file.size(), ++m_useCounter});
+        m_bytes += file.size();
+    }
+    evict();
+}
+
+void LogoCache::downloadNext() {
+    // a few downloads at a time leave the connections to TVHeadend to the EPG
+    while (m_downloads < m_maxDownloads && !m_waiting.isEmpty()) {
+        QString remoteUrl = m_waiting.dequeue();
+        m_downloads++;
+        m_queue->get(QNetworkRequest(QUrl(remoteUrl)), RequestQueue::Background, [=](QNetworkReply* reply) {
+            m_downloads--;
+            m_requested.remove(remoteUrl);
+            if (reply->error() == QNetworkReply::NoError &&
+                reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200) {
+                store(remoteUrl, reply->readAll());
+            }
+            downloadNext();
+        });
+    }
+}
+
+void LogoCache::store(const QString& remoteUrl, const QByteArray& data) {
+    // only images the UI can show are kept
+    QBuffer buffer;
+    buffer.setData(data);
+    if (data.isEmpty() || !QImageReader(&buffer).canRead()) {
+        return;
+    }
+    QString   name = fileName(remoteUrl);
+    QSaveFile file(m_directory + name);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        return;
+    }
+    m_entries.insert(name, {remoteUrl, data.size(), ++m_useCounter});
+    m_localUrls.insert(remoteUrl, QUrl::fromLocalFile(m_directory + name).toString());
+    m_bytes += data.size();
+    m_revision++;
+    evict();
+}
+
+void LogoCache::evict() {
+    while (m_bytes > m_maxBytes && !m_entries.isEmpty()) {
+        auto oldest = std::min_element(m_entries.begin(), m_entries.end(),
+                                       [](const Entry& a, const Entry& b) { return a.used < b.used; });
+        QFile::remove(m_directory + oldest.key());
+        m_localUrls.remove(oldest->remoteUrl);
+        m_bytes -= oldest->size;
+        m_entries.erase(oldest);
+        m_revision++;
+    }
+}
+
+QString LogoCache::fileName(const QString& remoteUrl) const {
+    return QString::fromLatin1(QCryptographicHash::hash(remoteUrl.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
@@ -0,0 +1,83 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#pragma once
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "requestqueue.h"
+
+// Keeps channel logos on local disk. Logos are downloaded in the background a few at a time, the least recently used
+// ones are deleted once the files exceed the size limit.
+class LogoCache : public QObject {
+    Q_OBJECT
+
+ public:
+    LogoCache(RequestQueue* queue, const QString& directory, qint64 maxBytes, int maxDownloads,
+              QObject* parent = nullptr);
+
+    // the file:// URL of the cached logo, remoteUrl itself while it is not cached. Counts as a use of the logo.
+    QString url(const QString& remoteUrl);
+    // remote URL to file:// URL of all cached logos, for use on other threads
+    QHash<QString, QString> urls() const { return m_localUrls; }
+    // counts as a use of the cached logos among remoteUrls, for models built from urls()
+    void touch(const QStringList& remoteUrls);
+    // increases with every stored logo
+    int revision() const { return m_revision; }
+
+    // downloads the logos which are not cached yet
+    void prefetch(const QStringList& remoteUrls);
+    // forgets the waiting downloads, called after the request queue was aborted
+    void cancel();
+
+ private:
+    struct Entry {
+        QString remoteUrl;
+        qint64  size;
+        qint64  used;
+    };
+
+    void    scan();
+    void    downloadNext();
+    void    store(const QString& remoteUrl, const QByteArray& data);
+    void    evict();
+    QString fileName(const QString& remoteUrl) const;
+
+    RequestQueue* m_queue;
+    QString       m_directory;
+    qint64        m_maxBytes;
+    int           m_maxDownloads;
+    // keyed by file name, files found on startup are ordered by their modification time
+    QHash<QString, Entry>   m_entries;
+    QHash<QString, QString> m_localUrls;
+    qint64                  m_bytes = 0;
+    qint64                  m_useCounter = 0;
+    int                     m_revision = 0;
+    QQueue<QString>         m_waiting;
+    // waiting or being downloaded, failed logos are requested again by the next prefetch
+    QSet<QString>           m_requested;
+    int                     m_downloads = 0;
+};
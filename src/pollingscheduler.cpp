@@ -0,0 +1,120 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#include "pollingscheduler.h"
+
+#define POLLING_MAX_FAILURES 16
+
+PollingScheduler::PollingScheduler(QObject* parent) : QObject(parent) {
+    m_timer.setSingleShot(true);
+    QObject::connect(&m_timer, &QTimer::timeout, this, &PollingScheduler::onTimeout);
+    m_clock.start();
+}
+
+int PollingScheduler::addTask(const Task& task, int intervalMs, int maxBackoffMs) {
+    m_entries.append({task, intervalMs, maxBackoffMs, 0, -1, 0, false});
+    return m_entries.count() - 1;
+}
+
+void PollingScheduler::start(int id, int delayMs) {
+    Entry& entry = m_entries[id];
+    entry.active = true;
+    entry.failures = 0;
+    entry.lastRun = -1;
+    entry.due = m_clock.elapsed() + delayMs;
+    arm();
+}
+
+void PollingScheduler::stop(int id) {
+    m_entries[id].active = false;
+    arm();
+}
+
+void PollingScheduler::stopAll() {
+    for (Entry& entry : m_entries) {
+        entry.active = false;
+    }
+    m_timer.stop();
+}
+
+bool PollingScheduler::isActive(int id) const { return m_entries.at(id).active; }
+
+void PollingScheduler::setInterval(int id, int intervalMs) {
+    Entry& entry = m_entries[id];
+    if (entry.interval != intervalMs) {
+        entry.interval = intervalMs;
+        reschedule(&entry);
+    }
+}
+
+void PollingScheduler::reportResult(int id, bool success) {
+    Entry& entry = m_entries[id];
+    int    failures = success ? 0 : qMin(entry.failures + 1, POLLING_MAX_FAILURES);
+    if (entry.failures != failures) {
+        entry.failures = failures;
+        reschedule(&entry);
+    }
+}
+
+void PollingScheduler::onTimeout() {
+    qint64 now = m_clock.elapsed();
+    // tasks may add or change entries, so the vector is accessed by index and the task is copied before the call
+    for (int i = 0; i < m_entries.count(); i++) {
+        if (m_entries[i].active && m_entries[i].due <= now) {
+            m_entries[i].lastRun = now;
+            m_entries[i].due = now + currentInterval(m_entries[i]);
+            Task task = m_entries[i].task;
+            task();
+        }
+    }
+    arm();
+}
+
+qint64 PollingScheduler::currentInterval(const Entry& entry) const {
+    if (entry.failures == 0) {
+        return entry.interval;
+    }
+    return qMin(static_cast<qint64>(entry.interval) << entry.failures,
+                static_cast<qint64>(qMax(entry.interval, entry.maxBackoff)));
+}
+
+void PollingScheduler::reschedule(Entry* entry) {
+    // a task which did not run yet keeps the delay it was started with
+    if (entry->active && entry->lastRun >= 0) {
+        entry->due = entry->lastRun + currentInterval(*entry);
+        arm();
+    }
+}
+
+void PollingScheduler::arm() {
+    qint64 due = -1;
+    for (const Entry& entry : m_entries) {
+        if (entry.active && (due < 0 || entry.due < due)) {
+            due = entry.due;
+        }
+    }
+    if (due < 0) {
+        m_timer.stop();
+    } else {
+        m_timer.start(static_cast<int>(qMax(static_cast<qint64>(0), due - m_clock.elapsed())));
+    }
+}
@@ -0,0 +1,74 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#pragma once
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <functional>
+
+// Runs all periodic work of the integration from a single timer. Every task has its own interval and deadline, the
+// timer is only armed for the earliest deadline, so tasks which are due at the same time share one wakeup. Failed
+// runs stretch the interval of a task exponentially until a run succeeds again.
+class PollingScheduler : public QObject {
+    Q_OBJECT
+
+ public:
+    typedef std::function<void()> Task;
+
+    explicit PollingScheduler(QObject* parent = nullptr);
+
+    // registers a task and returns its id, new tasks are stopped
+    int  addTask(const Task& task, int intervalMs, int maxBackoffMs);
+    void start(int id, int delayMs = 0);
+    void stop(int id);
+    void stopAll();
+    bool isActive(int id) const;
+
+    // a pending run is moved to the last run plus the new interval
+    void setInterval(int id, int intervalMs);
+    // a failure doubles the current interval up to the maximum backoff, a success restores the interval
+    void reportResult(int id, bool success);
+
+ private slots:
+    void onTimeout();
+
+ private:
+    struct Entry {
+        Task   task;
+        int    interval;
+        int    maxBackoff;
+        int    failures;
+        qint64 lastRun;
+        qint64 due;
+        bool   active;
+    };
+
+    qint64 currentInterval(const Entry& entry) const;
+    void   reschedule(Entry* entry);
+    void   arm();
+
+    QVector<Entry> m_entries;
+    QTimer         m_timer;
+    QElapsedTimer  m_clock;
+};
@@ -0,0 +1,101 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#include "requestqueue.h"
+
+RequestQueue::RequestQueue(QNetworkAccessManager* manager, int maxConnectionsPerHost, QObject* parent)
+    : QObject(parent), m_manager(manager), m_maxConnectionsPerHost(maxConnectionsPerHost) {}
+
+void RequestQueue::get(const QNetworkRequest& request, Priority priority, const ReplyHandler& handler) {
+    enqueue({request, QByteArray(), false, handler}, priority);
+}
+
+void RequestQueue::post(const QNetworkRequest& request, const QByteArray& data, Priority priority,
+                        const ReplyHandler& handler) {
+    enqueue({request, data, true, handler}, priority);
+}
+
+void RequestQueue::abortAll() {
+    for (QQueue<Request>& queue : m_queues) {
+        queue.clear();
+    }
+    // take the list first, abort() emits finished synchronously
+    QList<QNetworkReply*> replies = m_replies;
+    m_replies.clear();
+    m_runningPerHost.clear();
+    for (QNetworkReply* reply : replies) {
+        QObject::disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+        reply->deleteLater();
+    }
+}
+
+void RequestQueue::enqueue(const Request& request, Priority priority) {
+    if (priority == Interactive) {
+        start(request);
+    } else {
+        m_queues[priority].enqueue(request);
+        startQueued();
+    }
+}
+
+void RequestQueue::start(const Request& request) {
+    QString        host = hostKey(request.request.url());
+    ReplyHandler   handler = request.handler;
+    QNetworkReply* reply =
+        request.post ? m_manager->post(request.request, request.data) : m_manager->get(request.request);
+    m_runningPerHost[host]++;
+    m_replies.append(reply);
+    QObject::connect(reply, &QNetworkReply::finished, this, [=]() {
+        m_replies.removeOne(reply);
+        if (--m_runningPerHost[host] <= 0) {
+            m_runningPerHost.remove(host);
+        }
+        if (handler) {
+            handler(reply);
+        }
+        reply->deleteLater();
+        startQueued();
+    });
+}
+
+void RequestQueue::startQueued() {
+    // start the first request of the highest priority whose host has a free slot until none is left
+    bool started = true;
+    while (started) {
+        started = false;
+        for (QQueue<Request>& queue : m_queues) {
+            for (int i = 0; i < queue.count(); i++) {
+                if (m_runningPerHost.value(hostKey(queue.at(i).request.url())) < m_maxConnectionsPerHost) {
+                    start(queue.takeAt(i));
+                    started = true;
+                    break;
+                }
+            }
+            if (started) {
+                break;
+            }
+        }
+    }
+}
+
+QString RequestQueue::hostKey(const QUrl& url) const { return url.host() + ":" + QString::number(url.port()); }
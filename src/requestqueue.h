@@ -0,0 +1,70 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#pragma once
+#include <QHash>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QQueue>
+#include <functional>
+
+// Sends the HTTP requests of one QNetworkAccessManager in order of priority. Interactive requests are started at once,
+// all others wait until their host has a free slot, so a key press never waits behind a long EPG download.
+class RequestQueue : public QObject {
+    Q_OBJECT
+
+ public:
+    enum Priority { Interactive, NowPlaying, Background, PriorityCount };
+
+    // called with the finished reply, the reply is deleted afterwards
+    typedef std::function<void(QNetworkReply*)> ReplyHandler;
+
+    RequestQueue(QNetworkAccessManager* manager, int maxConnectionsPerHost, QObject* parent = nullptr);
+
+    void get(const QNetworkRequest& request, Priority priority, const ReplyHandler& handler);
+    void post(const QNetworkRequest& request, const QByteArray& data, Priority priority, const ReplyHandler& handler);
+
+    // aborts the running requests and drops the queued ones without calling their handlers
+    void abortAll();
+
+ private:
+    struct Request {
+        QNetworkRequest request;
+        QByteArray      data;
+        bool            post;
+        ReplyHandler    handler;
+    };
+
+    void    enqueue(const Request& request, Priority priority);
+    void    start(const Request& request);
+    void    startQueued();
+    QString hostKey(const QUrl& url) const;
+
+    QNetworkAccessManager* m_manager;
+    int                    m_maxConnectionsPerHost;
+    QQueue<Request>        m_queues[PriorityCount];
+    QHash<QString, int>    m_runningPerHost;
+    QList<QNetworkReply*>  m_replies;
+};
@@ -0,0 +1,55 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#include "stringpool.h"
+
+StringPool::StringPool() { clear(); }
+
+int StringPool::intern(const QString& value) {
+    if (value.isEmpty()) {
+        return 0;
+    }
+    auto it = m_handles.constFind(value);
+    if (it != m_handles.constEnd()) {
+        return it.value();
+    }
+    // the vector and the hash share the string data
+    int handle = m_strings.count();
+    m_strings.append(value);
+    m_handles.insert(value, handle);
+    m_bytes += value.size() * static_cast<qint64>(sizeof(QChar));
+    return handle;
+}
+
+int StringPool::handle(const QString& value) const {
+    if (value.isEmpty()) {
+        return 0;
+    }
+    return m_handles.value(value, -1);
+}
+
+void StringPool::clear() {
+    m_strings.clear();
+    m_handles.clear();
+    m_bytes = 0;
+    m_strings.append(QString());
+}
@@ -0,0 +1,46 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2020 Michael Lörcher <MichaelLoercher@web.de>
+ *
+ * This file is part of the YIO-Remote software project.
+ *
+ * YIO-Remote software is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * YIO-Remote software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with YIO-Remote software. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *****************************************************************************/
+
+#pragma once
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Keeps one copy of every distinct string and hands out integer handles for it. Handle 0 is the empty string. Copies
+// share the strings until one of them interns a new one, so a copy can be read by another thread.
+class StringPool {
+ public:
+    StringPool();
+
+    int            intern(const QString& value);
+    // handle of an interned string without adding it, -1 if it is not pooled
+    int            handle(const QString& value) const;
+    const QString& value(int handle) const { return m_strings.at(handle); }
+    int            count() const { return m_strings.count(); }
+    qint64         bytes() const { return m_bytes; }
+    void           clear();
+
+ private:
+    QVector<QString>    m_strings;
+    QHash<QString, int> m_handles;
+    qint64              m_bytes = 0;
+};